@@ -0,0 +1,38 @@
+#!/bin/sh
+# Copyright (c) 2023 BedRock Systems, Inc.
+# This software is distributed under the terms of the BedRock Open-Source License.
+# See the LICENSE-BedRock file in the repository root for details.
+#
+# Compares the size of the generated module and the time coqc takes to
+# compile it, with and without --compact, on the tests/cpp2v sources.
+#
+#   bench/compact.sh [CPP2V]
+#
+# Run from the repository root with COQPATH set as for the cram tests.
+set -e
+
+cpp2v="${1:-cpp2v}"
+tmp="$(mktemp -d)"
+trap 'rm -rf "$tmp"' EXIT
+
+# Prints the total size in bytes and the total coqc time in seconds of the
+# modules generated with the given extra cpp2v flags.
+measure() {
+  bytes=0
+  secs=0
+  for src in tests/cpp2v/*.t/test.cpp; do
+    out="$tmp/$(basename "$(dirname "$src")" .t)_cpp.v"
+    "$cpp2v" "$@" -o "$out" "$src" -- -std=c++17 2>/dev/null || continue
+    bytes=$((bytes + $(wc -c < "$out")))
+    start=$(date +%s.%N)
+    coqc -w -notation-overridden "$out" >/dev/null 2>&1
+    end=$(date +%s.%N)
+    secs=$(echo "$secs + $end - $start" | bc)
+  done
+  echo "$bytes $secs"
+}
+
+set -- $(measure)
+echo "pretty-printed: $1 bytes, coqc $2 s"
+set -- $(measure --compact)
+echo "compact:        $1 bytes, coqc $2 s"
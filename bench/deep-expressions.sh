@@ -0,0 +1,61 @@
+#!/bin/sh
+# Copyright (c) 2023 BedRock Systems, Inc.
+# This software is distributed under the terms of the BedRock Open-Source License.
+# See the LICENSE-BedRock file in the repository root for details.
+#
+# Measures the time and peak memory cpp2v takes to print machine-generated
+# chains [DEPTH] nodes deep: a left-associated [a + a + ...], an
+# [operator<<] chain, nested conditionals, an [else if] chain and a run of
+# [case] labels, and the size of the output. The output is printed with
+# [--compact], as indenting every level of a chain makes it quadratic in
+# [DEPTH]. A crash (e.g. a stack overflow) is reported as such.
+#
+#   bench/deep-expressions.sh [CPP2V] [DEPTH]
+set -e
+
+cpp2v="${1:-cpp2v}"
+depth="${2:-100000}"
+tmp="$(mktemp -d)"
+trap 'rm -rf "$tmp"' EXIT
+
+# Writes the translation unit of the chain [$1] to [$tmp/$1.cpp].
+generate() {
+  awk -v n="$depth" -v kind="$1" 'BEGIN {
+    printf "struct Out { Out& operator<<(int); };\n";
+    if (kind == "sum") {
+      printf "int f(int a) { return a";
+      for (i = 1; i < n; ++i) printf " + a";
+      printf "; }\n";
+    } else if (kind == "shift") {
+      printf "Out& f(Out& o, int a) { return o";
+      for (i = 1; i < n; ++i) printf " << a";
+      printf "; }\n";
+    } else if (kind == "conditional") {
+      printf "int f(int a) { return";
+      for (i = 1; i < n; ++i) printf " a == %d ? %d :", i, i;
+      printf " 0; }\n";
+    } else if (kind == "else-if") {
+      printf "int f(int a) {";
+      for (i = 1; i < n; ++i) printf " if (a == %d) return %d; else", i, i;
+      printf " return 0; }\n";
+    } else if (kind == "case") {
+      printf "int f(int a) { switch (a) {";
+      for (i = 1; i < n; ++i) printf " case %d:", i;
+      printf " return 1; } return 0; }\n";
+    }
+  }' > "$tmp/$1.cpp"
+}
+
+for kind in sum shift conditional else-if case; do
+  generate "$kind"
+  start=$(date +%s.%N)
+  if mem=$(/usr/bin/time -f %M "$cpp2v" --compact -o "$tmp/$kind.v" \
+      "$tmp/$kind.cpp" -- -std=c++17 2>&1 >/dev/null | tail -n 1) &&
+      [ -s "$tmp/$kind.v" ]; then
+    end=$(date +%s.%N)
+    size=$(wc -c < "$tmp/$kind.v")
+    echo "$kind: $(echo "$end - $start" | bc) s, $mem KiB, $size bytes"
+  else
+    echo "$kind: failed"
+  fi
+done
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+
+// Measures the throughput of fmt::Formatter on real cpp2v output.
+//
+//   formatter-bench [-n REPEAT] [-o OUT] [-compact] FILE.v
+//
+// The lines of FILE.v are split into tokens and indentation once, and then
+// replayed through a Formatter REPEAT times, writing to OUT (/dev/null by
+// default). Replaying a file written by cpp2v reproduces it byte for byte;
+// with -compact, it approximates the output of cpp2v --compact.
+#include "Formatter.hpp"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<std::string> Input(cl::Positional, cl::desc("<file.v>"),
+                                  cl::Required);
+static cl::opt<unsigned> Repeat("n", cl::desc("number of replays"),
+                                cl::init(10));
+static cl::opt<std::string> Output("o", cl::desc("output file"),
+                                   cl::init("/dev/null"));
+static cl::opt<bool> Compact("compact", cl::desc("replay in compact mode"));
+
+namespace {
+struct Line {
+    unsigned depth;
+    bool odd; // an indentation that is not a multiple of 2
+    SmallVector<StringRef, 8> tokens;
+};
+} // namespace
+
+static std::vector<Line>
+parse(StringRef data) {
+    std::vector<Line> lines;
+    while (not data.empty()) {
+        StringRef text;
+        std::tie(text, data) = data.split('\n');
+        auto body = text.ltrim(' ');
+        unsigned indent = text.size() - body.size();
+        Line line{indent & ~1u, (indent & 1) != 0, {}};
+        if (not body.empty()) {
+            body.split(line.tokens, ' ');
+        }
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+static void
+replay(const std::vector<Line>& lines, fmt::Formatter& fmt) {
+    unsigned depth = 0;
+    for (auto& line : lines) {
+        for (; depth < line.depth; depth += 2) {
+            fmt << fmt::indent;
+        }
+        for (; line.depth < depth; depth -= 2) {
+            fmt << fmt::outdent;
+        }
+        if (line.odd) {
+            fmt << fmt::nbsp;
+        }
+        bool first = true;
+        for (auto token : line.tokens) {
+            if (not first) {
+                fmt << fmt::nbsp;
+            }
+            if (token == "::") {
+                // As printed by [CoqPrinter::cons].
+                fmt.glue();
+                fmt << token;
+                fmt.glue();
+            } else {
+                fmt << token;
+            }
+            first = false;
+        }
+        fmt << fmt::line;
+    }
+    for (; 0 < depth; depth -= 2) {
+        fmt << fmt::outdent;
+    }
+}
+
+int
+main(int argc, char** argv) {
+    cl::ParseCommandLineOptions(argc, argv, "fmt::Formatter benchmark\n");
+
+    auto buf = MemoryBuffer::getFile(Input);
+    if (not buf) {
+        errs() << Input << ": " << buf.getError().message() << "\n";
+        return 1;
+    }
+    auto lines = parse((*buf)->getBuffer());
+
+    std::error_code ec;
+    raw_fd_ostream out(Output, ec);
+    if (ec) {
+        errs() << Output << ": " << ec.message() << "\n";
+        return 1;
+    }
+
+    uint64_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < Repeat; ++i) {
+        auto before = out.tell();
+        {
+            fmt::Formatter::State start;
+            start.compact = Compact;
+            fmt::Formatter fmt(out, start);
+            replay(lines, fmt);
+        }
+        bytes += out.tell() - before;
+    }
+    out.flush();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    outs() << bytes << " bytes in " << elapsed.count() << " s: "
+           << format("%.1f", bytes / elapsed.count() / (1 << 20))
+           << " MiB/s\n";
+    return 0;
+}
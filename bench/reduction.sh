@@ -0,0 +1,52 @@
+#!/bin/sh
+# Copyright (c) 2023 BedRock Systems, Inc.
+# This software is distributed under the terms of the BedRock Open-Source License.
+# See the LICENSE-BedRock file in the repository root for details.
+#
+# Compares the time and peak memory coqc takes to compile the generated
+# modules with each --reduction strategy, on the tests/cpp2v sources and on
+# a synthetic translation unit of [FUNCTIONS] functions.
+#
+#   bench/reduction.sh [CPP2V] [FUNCTIONS]
+#
+# Run from the repository root with COQPATH set as for the cram tests.
+set -e
+
+cpp2v="${1:-cpp2v}"
+functions="${2:-5000}"
+tmp="$(mktemp -d)"
+trap 'rm -rf "$tmp"' EXIT
+
+awk -v n="$functions" 'BEGIN {
+  printf "struct S { int x; int y; };\n";
+  for (i = 0; i < n; ++i)
+    printf "int f%d(S* s, int a) { if (a < %d) return s->x + a; return f%d(s, a - 1) * s->y; }\n", i, i, i > 0 ? i - 1 : 0;
+}' > "$tmp/large.cpp"
+
+# Prints the total coqc time in seconds and the largest peak memory in KiB
+# for the modules generated from the given sources with --reduction=$1.
+measure() {
+  reduction="$1"
+  shift
+  secs=0
+  kib=0
+  for src in "$@"; do
+    out="$tmp/$(basename "$(dirname "$src")" .t)_$(basename "$src" .cpp)_cpp.v"
+    "$cpp2v" --reduction="$reduction" -o "$out" "$src" -- -std=c++17 \
+      2>/dev/null || continue
+    start=$(date +%s.%N)
+    mem=$(/usr/bin/time -f %M coqc -w -notation-overridden "$out" \
+      2>&1 >/dev/null | tail -n 1)
+    end=$(date +%s.%N)
+    secs=$(echo "$secs + $end - $start" | bc)
+    if [ "$mem" -gt "$kib" ] 2>/dev/null; then
+      kib="$mem"
+    fi
+  done
+  echo "$secs s, $kib KiB"
+}
+
+for reduction in vm native lazy-per-chunk; do
+  echo "$reduction: tests/cpp2v $(measure "$reduction" tests/cpp2v/*.t/test.cpp)," \
+    "large $(measure "$reduction" "$tmp/large.cpp")"
+done
@@ -0,0 +1,45 @@
+#!/bin/sh
+# Copyright (c) 2023 BedRock Systems, Inc.
+# This software is distributed under the terms of the BedRock Open-Source License.
+# See the LICENSE-BedRock file in the repository root for details.
+#
+# Compares the size of the module generated for a translation unit full of
+# string tables and binary blobs, and the time coqc takes to compile it,
+# between two builds of cpp2v (e.g. before and after a change to how string
+# literals are printed).
+#
+#   bench/string-literals.sh OLD-CPP2V NEW-CPP2V [TABLES]
+#
+# Run from the repository root with COQPATH set as for the cram tests.
+set -e
+
+old="$1"
+new="$2"
+tables="${3:-50}"
+tmp="$(mktemp -d)"
+trap 'rm -rf "$tmp"' EXIT
+
+# [TABLES] functions, each returning a table of text strings and a 1 KiB
+# blob of pseudo-random bytes.
+awk -v n="$tables" 'BEGIN {
+  srand(1);
+  for (t = 0; t < n; ++t) {
+    printf "const char* text_%d[] = {\n", t;
+    for (i = 0; i < 16; ++i)
+      printf "  \"message %d.%d: the quick brown fox jumps over the lazy dog\\n\",\n", t, i;
+    printf "};\n";
+    printf "const char* blob_%d() {\n  return \"", t;
+    for (i = 0; i < 1024; ++i)
+      printf "\\x%02x", int(rand() * 256);
+    printf "\";\n}\n";
+  }
+}' > "$tmp/strings.cpp"
+
+for cpp2v in "$old" "$new"; do
+  "$cpp2v" -o "$tmp/strings_cpp.v" "$tmp/strings.cpp" -- -std=c++17
+  bytes=$(wc -c < "$tmp/strings_cpp.v")
+  start=$(date +%s.%N)
+  coqc -w -notation-overridden "$tmp/strings_cpp.v" >/dev/null
+  end=$(date +%s.%N)
+  echo "$cpp2v: $bytes bytes, coqc $(echo "$end - $start" | bc) s"
+done
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include "CoqPrinter.hpp"
+#include "Formatter.hpp"
+#include <llvm/Support/raw_ostream.h>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+
+class ClangPrinter;
+namespace clang {
+class Decl;
+}
+
+// The symbol and type tables of the module for [--canonical-tables].
+//
+// Instead of a list of [Dfunction], [Dstruct], ... that Coq inserts one by
+// one into AVL trees, every entry is printed once, in the usual order, and
+// kept under the key it would be inserted at; the last one printed for a key
+// wins, like in [decls]. [print] then writes each table as a perfectly
+// balanced [IM.Raw.t] in [bs_cmp] order, so that Coq only has to check it
+// with [avl.check_canon].
+class CanonicalTables {
+public:
+    explicit CanonicalTables(bool compact);
+
+    // The printer for the next entry. Call [add] once it has been printed.
+    CoqPrinter& entry();
+    // Keep what was printed since [entry], if anything, as the entry of
+    // [decl]; [cprint] names it as it was printed.
+    void add(const clang::Decl* decl, ClangPrinter& cprint);
+
+    // Print [module_symbols], [module_types] and [module], computing the
+    // tables with the reduction [reduction].
+    void print(CoqPrinter& print, const char* reduction,
+               const char* endian) const;
+
+private:
+    enum Table { SYMBOLS, TYPES, TABLES };
+
+    // The table and key of the entry of [decl], e.g. [_Z3foov] for
+    // [(Dfunction "_Z3foov" ...)], or none for entries that do not go in a
+    // table (static assertions).
+    static std::optional<std::pair<Table, std::string>>
+    key_of(const clang::Decl* decl, ClangPrinter& cprint);
+
+    struct Entry {
+        size_t begin;
+        size_t end;
+        fmt::Formatter::State after;
+    };
+    using Map = std::map<std::string, Entry>;
+
+    void print_table(CoqPrinter& print, const char* reduction,
+                     const char* name, const char* type,
+                     const Map& table) const;
+
+    // All entries are printed to [text_], starting from [start_].
+    std::string text_;
+    llvm::raw_string_ostream os_;
+    fmt::Formatter out_;
+    CoqPrinter print_;
+    const fmt::Formatter::State start_;
+    size_t begin_{0};
+    // [std::string] compares like [bs_cmp]: bytewise, as unsigned.
+    Map tables_[TABLES];
+};
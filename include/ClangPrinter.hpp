@@ -4,8 +4,13 @@
  * See the LICENSE-BedRock file in the repository root for details.
  */
 #pragma once
+#include "Formatter.hpp"
 #include <clang/Basic/Diagnostic.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/Optional.h>
+#include <memory>
+#include <string>
+#include <tuple>
 
 namespace clang {
 class Decl;
@@ -29,10 +34,37 @@ class TypeDecl;
 }
 
 class CoqPrinter;
+class InternedNames;
+class LazyBodies;
+class SharedTypes;
 struct OpaqueNames;
 
 bool is_dependent(const clang::Expr*);
 
+// The names that [printObjName] and [printTypeName] render (mangling them
+// on the way), by declaration. A translation unit refers to few names many
+// times, so its printers share one cache (see [ClangPrinter::share_names]).
+struct NameCache {
+    llvm::DenseMap<const clang::Decl*, std::string> names;
+    unsigned hits{0};
+    unsigned misses{0};
+};
+
+// The text that [printQualType] printed for a type, by the type (sugar
+// included, which is printed), the interned names it went through and the
+// layout state it started from, without the depth: only text without line
+// breaks that does not start a line is kept, so the depth does not matter.
+struct TypeCache {
+    using Key = std::tuple<const void*, const void*, unsigned>;
+    struct Entry {
+        std::string text;
+        fmt::Formatter::State after;
+    };
+    llvm::DenseMap<Key, Entry> types;
+    unsigned hits{0};
+    unsigned misses{0};
+};
+
 class ClangPrinter {
 public:
     bool printDecl(const clang::Decl* d, CoqPrinter& print);
@@ -41,6 +73,9 @@ public:
 
     void printStmt(const clang::Stmt* s, CoqPrinter& print);
 
+    // Print the body of a function, method, constructor or destructor.
+    void printBody(const clang::Stmt* body, CoqPrinter& print);
+
     void printType(const clang::Type* t, CoqPrinter& print);
 
     void printExpr(const clang::Expr* d, CoqPrinter& print);
@@ -53,6 +88,11 @@ public:
                       bool raw = false);
     void printTypeName(const clang::TypeDecl* decl, CoqPrinter& print) const;
 
+    // The names that [printObjName] and [printTypeName] print for [decl], as
+    // Coq computes them (e.g. through [parser.DTOR]).
+    std::string objName(const clang::ValueDecl* decl);
+    const std::string& typeName(const clang::TypeDecl* decl) const;
+
     void printParamName(const clang::ParmVarDecl* d, CoqPrinter& print) const;
 
     // Printing types
@@ -85,8 +125,52 @@ public:
         return *compiler_;
     }
 
+    // Print the types of the module through [types] (see SharedTypes.hpp),
+    // or in place if null.
+    void share_types(SharedTypes* types) {
+        types_ = types;
+    }
+
+    // Print the names of the module through [names] (see InternedNames.hpp),
+    // or in place if null.
+    void intern_names(InternedNames* names) {
+        names_ = names;
+    }
+
+    // Print the function bodies of the module through [bodies] (see
+    // LazyBodies.hpp), or in place if null.
+    void lazy_bodies(LazyBodies* bodies) {
+        bodies_ = bodies;
+    }
+
+    // Look names up in the cache of [other], and mangle the names that miss
+    // it with the mangler of [other], from now on. The mangler numbers
+    // unnamed entities (lambdas, anonymous types) in the order it meets them,
+    // so the printers of a translation unit only agree on the numbers if
+    // they share it.
+    void share_names(const ClangPrinter& other) {
+        name_cache_ = other.name_cache_;
+        mangleContext_ = other.mangleContext_;
+    }
+
+    const NameCache& name_cache() const {
+        return *name_cache_;
+    }
+
+    const TypeCache& type_cache() const {
+        return type_cache_;
+    }
+
 private:
     clang::CompilerInstance* compiler_;
     clang::ASTContext* context_;
-    clang::MangleContext* mangleContext_;
+    std::shared_ptr<clang::MangleContext> mangleContext_;
+    SharedTypes* types_{nullptr};
+    InternedNames* names_{nullptr};
+    LazyBodies* bodies_{nullptr};
+    std::shared_ptr<NameCache> name_cache_;
+    TypeCache type_cache_;
+
+    void printQualTypeText(const clang::QualType& qt, CoqPrinter& print);
+    const std::string& mangledName(const clang::ValueDecl* decl);
 };
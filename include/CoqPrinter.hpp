@@ -131,6 +131,12 @@ public:
         return this->output_ << "nil" << fmt::rparen;
     }
     fmt::Formatter& cons() {
+        if (this->output_.is_compact()) {
+            this->output_.glue();
+            this->output_ << "::";
+            this->output_.glue();
+            return this->output_;
+        }
         return this->output_ << fmt::nbsp << "::" << fmt::nbsp;
     }
 
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include "Formatter.hpp"
+#include <llvm/ADT/StringMap.h>
+#include <optional>
+#include <string>
+
+namespace clang {
+class ASTContext;
+class Decl;
+}
+
+class CoqPrinter;
+class ClangPrinter;
+
+// A side-car cache of the Coq text rendered for individual declarations,
+// so that re-running cpp2v after a small edit only re-prints the
+// declarations that changed.
+//
+// Entries are keyed on a fingerprint of the declaration: its name and
+// type, its source text, and a walk of its AST that records every type,
+// operator, literal and referenced declaration. Only functions and
+// variables are cached; everything else is always printed.
+//
+// The cache of a translation unit lives in a single file of [dir], named
+// after the path of the main file. [save] rewrites it with the entries used
+// by the current run.
+class DeclCache {
+public:
+    DeclCache(llvm::StringRef dir, const clang::ASTContext& ctxt);
+
+    // Print [decl] like [ClangPrinter::printDecl], replaying the cached text
+    // when the fingerprint of [decl] is known.
+    bool printDecl(const clang::Decl* decl, CoqPrinter& print,
+                   ClangPrinter& cprint);
+
+    void save() const;
+
+    unsigned hits() const {
+        return hits_;
+    }
+    unsigned misses() const {
+        return misses_;
+    }
+
+private:
+    struct Entry {
+        std::string text;
+        fmt::Formatter::State after;
+        bool printed;
+    };
+
+    std::optional<std::string> fingerprint(const clang::Decl* decl,
+                                           fmt::Formatter::State state,
+                                           bool templates) const;
+
+    std::string file_;
+    const clang::ASTContext& ctxt_;
+    // The entries read from [file_], and those used by this run.
+    llvm::StringMap<Entry> old_;
+    llvm::StringMap<Entry> new_;
+    unsigned hits_{0};
+    unsigned misses_{0};
+};
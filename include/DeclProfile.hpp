@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <llvm/ADT/StringRef.h>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}
+
+namespace clang {
+class ASTContext;
+class Decl;
+}
+
+namespace fmt {
+class Formatter;
+}
+
+// The size and printing time of every top-level declaration, for
+// [--decl-profile] and [--decl-profile-top].
+class DeclProfile {
+public:
+    explicit DeclProfile(const clang::ASTContext& ctxt) : ctxt_(ctxt) {}
+
+    struct Start {
+        uint64_t offset;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    // Call before printing a declaration to [out]...
+    Start start(const fmt::Formatter& out) const;
+    // ...and after, if it was printed.
+    void record(const clang::Decl* decl, const fmt::Formatter& out,
+                bool templates, const Start& start);
+
+    // Write every record as JSON, in printing order.
+    void write(llvm::raw_ostream& os, llvm::StringRef file) const;
+
+    // Print the [n] largest declarations.
+    void print_top(llvm::raw_ostream& os, unsigned n) const;
+
+private:
+    struct Record {
+        std::string name;
+        const char* kind;
+        std::string location;
+        bool templates;
+        uint64_t bytes;
+        double seconds;
+    };
+
+    const clang::ASTContext& ctxt_;
+    std::vector<Record> records_;
+};
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace clang {
+class CompilerInstance;
+class Decl;
+class TranslationUnitDecl;
+}
+
+class Elaborate;
+class Filter;
+
+// Defines the implicit members of the declarations of a translation unit as
+// clang hands them over. It remembers what it elaborated across callbacks,
+// so each declaration is walked once (records twice at most, the second time
+// for their members), and elaboration that Sema triggers from within
+// elaboration is queued rather than nested.
+class Elaborator {
+public:
+    Elaborator(clang::CompilerInstance*, bool templates);
+    ~Elaborator();
+
+    // Elaborate [decl], and with [recursive] the declarations in it.
+    void add(clang::Decl* decl, bool recursive);
+
+    // Elaborate the records that the definitions of [tu] that [filter]
+    // prints refer to, transitively (for [--lazy-elaboration]). Only the
+    // definitions that [filter] prints are followed, as in Slice.hpp.
+    void demand(const clang::TranslationUnitDecl* tu, Filter& filter);
+
+    // The number of declarations elaborated so far.
+    unsigned declarations() const;
+    // The number of implicit members defined so far.
+    unsigned implicit_members() const;
+
+private:
+    std::unique_ptr<Elaborate> elab_;
+    std::vector<std::pair<clang::Decl*, bool>> worklist_;
+    bool running_{false};
+};
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include "Filter.hpp"
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/GlobPattern.h>
+#include <llvm/Support/Regex.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// The rules of a filter-spec file for [--filter]. Every line is a rule
+//
+//   (definition | declaration | exclude) (path | namespace | name) PATTERN
+//
+// with its words separated by blanks, or a comment starting with [#]. [path] matches the presumed file name of
+// a declaration and [namespace] the qualified name of its innermost
+// enclosing namespace (empty at the top level), both with glob patterns;
+// [name] matches its qualified name with a regular expression. The last
+// rule that matches a declaration decides whether to print its definition,
+// only a declaration, or nothing; declarations that no rule matches are
+// printed in full.
+class FilterSpec {
+public:
+    // Report the first error in [text] as "LINE: message".
+    static std::optional<FilterSpec> parse(llvm::StringRef text,
+                                           std::string& error);
+
+    enum Kind { PATH, NAMESPACE, NAME };
+
+    struct Rule {
+        Filter::What what;
+        Kind kind;
+        // For [PATH] and [NAMESPACE].
+        std::optional<llvm::GlobPattern> glob;
+        // For [NAME].
+        std::shared_ptr<llvm::Regex> regex;
+    };
+
+    const std::vector<Rule>& rules() const {
+        return rules_;
+    }
+
+private:
+    std::vector<Rule> rules_;
+};
+
+// The filter of one translation unit for a [FilterSpec]. The path and
+// namespace rules are only evaluated once per presumed file name and per
+// namespace; name rules are only tried when they come after every rule that
+// matched so far.
+class SpecFilter : public Filter {
+public:
+    SpecFilter(const FilterSpec& spec, const SourceManager& sm)
+        : spec_(spec), sm_(sm) {}
+
+    virtual What shouldInclude(const Decl* d) override;
+
+private:
+    // The index of the last rule of [kind] that matches [text], or -1.
+    int last_match(FilterSpec::Kind kind, llvm::StringRef text) const;
+
+    const FilterSpec& spec_;
+    const SourceManager& sm_;
+    // By presumed file name.
+    llvm::StringMap<int> by_file_;
+    llvm::DenseMap<const DeclContext*, int> by_namespace_;
+};
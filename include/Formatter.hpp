@@ -12,16 +12,60 @@
 
 namespace fmt {
 
+// A stream with a large buffer in front of another stream. Tokens are
+// copied into one contiguous buffer and reach the underlying stream in
+// large chunks.
+class ChunkedStream : public llvm::raw_ostream {
+public:
+    ChunkedStream(llvm::raw_ostream& out, size_t buffer_size);
+    ~ChunkedStream() override;
+
+private:
+    void write_impl(const char* ptr, size_t size) override;
+    uint64_t current_pos() const override {
+        return pos_;
+    }
+
+    llvm::raw_ostream& out_;
+    uint64_t pos_{0};
+};
+
 class Formatter {
+public:
+    // The buffer size for files; cpp2v output is often tens of megabytes.
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    // In compact mode, line breaks are only kept up to this depth, so that
+    // every top-level declaration starts on a line of its own.
+    static constexpr unsigned int COMPACT_DEPTH = 4;
+
 private:
-    llvm::raw_ostream& out;
+    ChunkedStream out;
     unsigned int depth;
     unsigned int spaces;
     bool blank;
+    // Compact mode: no space is needed before the next token, e.g. after
+    // [(] or a line break (see [glue]).
+    bool open;
+    // Emit the fewest spaces and line breaks that separate the tokens,
+    // without indentation.
+    bool compact;
+
+public:
+    // The layout state between two pieces of output. Text rendered from one
+    // state can be replayed verbatim from the same state (see [splice]).
+    struct State {
+        unsigned int depth{0};
+        unsigned int spaces{0};
+        bool blank{true};
+        bool open{false};
+        bool compact{false};
+    };
 
 public:
     explicit Formatter();
-    explicit Formatter(llvm::raw_ostream&);
+    explicit Formatter(llvm::raw_ostream&, size_t buffer_size = BUFFER_SIZE);
+    Formatter(llvm::raw_ostream&, State, size_t buffer_size = BUFFER_SIZE);
 
     llvm::raw_ostream& line();
 
@@ -29,13 +73,38 @@ public:
 
     void nbsp();
 
+    // In compact mode, the tokens on either side of this point need no
+    // space between them.
+    void glue();
+
     void indent();
     void outdent();
 
+    void lparen();
+    void rparen();
+
     void ascii(int c);
 
     llvm::raw_ostream& error() const;
 
+    // The number of bytes written so far.
+    uint64_t tell() const {
+        return out.tell();
+    }
+
+    // Push the buffered output to the underlying stream.
+    void flush() {
+        out.flush();
+    }
+
+    State state() const {
+        return State{depth, spaces, blank, open, compact};
+    }
+
+    // Emit [text], which was rendered starting from [state()] and ended in
+    // [after].
+    void splice(llvm::StringRef text, State after);
+
     template<typename T>
     Formatter& operator<<(T val) {
         nobreak() << val;
@@ -49,6 +118,10 @@ public:
         return depth;
     }
 
+    bool is_compact() const {
+        return compact;
+    }
+
 public:
     static Formatter default_output;
 };
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include "CoqPrinter.hpp"
+#include "Formatter.hpp"
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace clang {
+class Decl;
+class SourceManager;
+}
+
+// The declarations of a translation unit that come from included files, for
+// [--header-modules]. Each header gets a module of its own, named after the
+// header and a hash of its contents, e.g. [h_foo_hpp_0123456789abcdef.v].
+// Translation units that print the same declarations from a header share
+// the file, and those that do not (e.g. with different macros) get their
+// own.
+class HeaderModules {
+public:
+    HeaderModules(const clang::SourceManager& sm, std::string dir,
+                  bool compact);
+    ~HeaderModules();
+
+    // The printer for [decl] if it belongs to the module of a header.
+    // Template instantiations and implicit declarations depend on the
+    // translation unit, so they stay in its own module.
+    CoqPrinter* entry(const clang::Decl* decl);
+
+    // Write the module of every header, unless it already exists, and
+    // return their names in the order the headers were first seen. A module
+    // that cannot be written is reported as an error and left out.
+    std::vector<std::string> write(const char* reduction, const char* endian);
+
+private:
+    void report(llvm::StringRef path, std::error_code ec);
+
+    struct Header {
+        std::string file;
+        std::string text;
+        llvm::raw_string_ostream os{text};
+        fmt::Formatter out;
+        CoqPrinter print{out, false};
+
+        Header(std::string file, fmt::Formatter::State start)
+            : file(std::move(file)), out(os, start, 0) {}
+    };
+
+    const clang::SourceManager& sm_;
+    const std::string dir_;
+    const bool compact_;
+    llvm::StringMap<Header*> index_;
+    std::vector<std::unique_ptr<Header>> headers_;
+};
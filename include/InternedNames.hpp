@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}
+
+class CoqPrinter;
+
+// The names of a module for [--intern-names]: every name that cpp2v would
+// print as a string literal is defined once, as
+// [Definition n_k : obj_name := "..."], and referred to by [n_k]. Names
+// whose literal is no longer than [n_k] are printed in place.
+class InternedNames {
+public:
+    // Print [name] to [print]. [type] is the Coq type of the name, and
+    // [source] its name in the source, for the mapping file.
+    void print(llvm::StringRef name, const char* type, CoqPrinter& print,
+               llvm::function_ref<std::string()> source);
+
+    // The name that [ident] refers to, if it is an [n_k].
+    std::optional<llvm::StringRef> lookup(llvm::StringRef ident) const;
+
+    void print_definitions(CoqPrinter& print) const;
+
+    // Write a line [n_k <tab> name <tab> source name] for every definition.
+    void write_map(llvm::raw_ostream& os) const;
+
+    bool empty() const {
+        return names_.empty();
+    }
+
+private:
+    struct Name {
+        std::string name;
+        const char* type;
+        std::string source;
+    };
+
+    llvm::StringMap<unsigned> index_;
+    std::vector<Name> names_;
+};
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include <llvm/ADT/STLExtras.h>
+#include <string>
+#include <vector>
+
+class CoqPrinter;
+
+// The function bodies of a module for [--lazy-bodies]: every body is
+// defined on its own, as [Definition body_k : Stmt := ...], and the module
+// refers to it by [body_k]. The list of declarations is reduced as a
+// function of the bodies, [module_shape], so that computing the tables
+// never unfolds a body; [module] then applies it to the [body_k].
+class LazyBodies {
+public:
+    // Print a reference to a body. [print_body] prints the body itself.
+    void print(CoqPrinter& print,
+               llvm::function_ref<void(CoqPrinter&)> print_body);
+
+    void print_definitions(CoqPrinter& print) const;
+
+    // Print [body_0 ... body_n], the parameters of [module_shape] and its
+    // arguments in [module].
+    void print_names(CoqPrinter& print) const;
+
+    bool empty() const {
+        return bodies_.empty();
+    }
+
+private:
+    std::vector<std::string> bodies_;
+};
@@ -37,5 +37,11 @@ debug() {
 
 void set_level(Level level);
 
+// Redirect the log of the calling thread to [out] (or back to [llvm::errs()]
+// if [out] is null). The parallel driver uses this to keep the output of
+// different translation units apart. Fatal errors always go to
+// [llvm::errs()].
+void set_stream(llvm::raw_ostream* out);
+
 [[noreturn]] void die();
 }
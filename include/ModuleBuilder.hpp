@@ -6,8 +6,10 @@
 #pragma once
 #include <clang/AST/Decl.h>
 #include <clang/AST/DeclCXX.h>
+#include <llvm/ADT/STLExtras.h>
 #include <list>
 #include <map>
+#include <memory>
 #include <set>
 #include <utility>
 
@@ -34,6 +36,12 @@ public:
     using AssertList = std::list<const clang::StaticAssertDecl*>;
     using DeclList = std::list<const clang::NamedDecl*>;
 
+    // Drop the declarations, definitions and assertions that do not satisfy
+    // [keep] and [keep_assert]. The template lists are left alone.
+    void retain(llvm::function_ref<bool(const clang::NamedDecl*)> keep,
+                llvm::function_ref<bool(const clang::StaticAssertDecl*)>
+                    keep_assert);
+
     const AssertList& asserts() const {
         return asserts_;
     }
@@ -73,3 +81,25 @@ class SpecCollector;
 void build_module(clang::TranslationUnitDecl* tu, ::Module& mod, Filter& filter,
                   SpecCollector& specs, clang::CompilerInstance*,
                   bool elaborate, bool templates);
+
+class BuildModule;
+
+// Builds a module while the translation unit is parsed, for [--stream].
+// [add_final] adds the declarations of a top-level group whose output can no
+// longer change; [finish] adds everything else, as [build_module] would.
+// With [header_declarations], the first declaration of an entity in an
+// included file is added even if the entity is defined (for
+// [--header-modules]).
+class ModuleBuilder {
+public:
+    ModuleBuilder(::Module& mod, Filter& filter, SpecCollector& specs,
+                  clang::CompilerInstance*, bool templates,
+                  bool header_declarations = false);
+    ~ModuleBuilder();
+
+    void add_final(const clang::Decl* decl);
+    void finish(const clang::TranslationUnitDecl* tu);
+
+private:
+    std::unique_ptr<BuildModule> builder_;
+};
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include <cstdint>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/StringRef.h>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+namespace vfs {
+class FileSystem;
+}
+}
+
+namespace clang {
+namespace tooling {
+class CompilationDatabase;
+}
+class FileManager;
+}
+
+// A ccache-style cache for the files generated by cpp2v.
+//
+// Entries are keyed on the preprocessed source (see [cache_key]) and
+// contain one file per output "slot" (e.g. the module, the names file).
+// The cache lives in a directory that can be shared between concurrent
+// runs of cpp2v; it is trimmed to [max_size] bytes by evicting the least
+// recently used entries.
+class OutputCache {
+public:
+    // A slot name and the path of the corresponding output, if requested.
+    using Outputs =
+        std::vector<std::pair<std::string, std::optional<std::string>>>;
+
+    OutputCache(std::string dir, uint64_t max_size)
+        : dir_(std::move(dir)), max_size_(max_size) {}
+
+    // Copy the outputs stored under [key] to their paths.
+    // Returns [false] on a miss.
+    bool restore(llvm::StringRef key, const Outputs& outputs);
+
+    // Store the freshly generated outputs under [key].
+    void store(llvm::StringRef key, const Outputs& outputs);
+
+    void print_stats(llvm::raw_ostream& os);
+
+private:
+    std::string entry_path(llvm::StringRef key) const;
+    void count(bool hit);
+    void evict();
+
+    const std::string dir_;
+    const uint64_t max_size_;
+};
+
+// Compute the cache key of [source]: a hash of the cpp2v version, [mode]
+// (everything else that affects the contents of the outputs), the compiler
+// arguments and the preprocessed source, including comments.
+// Returns nothing if [source] cannot be preprocessed.
+std::optional<std::string>
+cache_key(const clang::tooling::CompilationDatabase& db,
+          const std::string& source, llvm::StringRef mode,
+          clang::FileManager* files = nullptr);
+
+// The file system for a [ClangTool] that reads through [files] (a
+// [FileManager] of its own if null).
+llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>
+job_file_system(clang::FileManager* files);
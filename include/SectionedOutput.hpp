@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include "CoqPrinter.hpp"
+#include "Formatter.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_fd_ostream;
+}
+
+// A generated file whose list of declarations is printed in a fixed sequence
+// of sections, e.g. all declarations before all definitions. Entries of the
+// current section go straight to the file; entries of later sections are
+// spilled to temporary files and copied in when [advance] reaches them. This
+// lets [--stream] print declarations in whatever order they become final.
+class SectionedOutput {
+public:
+    // Report the error and return null if [path] cannot be written.
+    static std::unique_ptr<SectionedOutput>
+    open(const std::string& path, unsigned sections, bool compact,
+         bool templates);
+    ~SectionedOutput();
+
+    // The printer for the header and trailer around the sections.
+    CoqPrinter& printer() {
+        return print_;
+    }
+
+    // The printer for the entries of [section], which must not have been
+    // passed by [advance] yet.
+    CoqPrinter& section(unsigned section);
+
+    // No more entries will be added before [section]: copy the spilled
+    // sections up to it into the file, and print its entries directly.
+    // [advance(sections)] finishes the list.
+    void advance(unsigned section);
+
+private:
+    struct Spill;
+
+    SectionedOutput(std::unique_ptr<llvm::raw_fd_ostream> file, unsigned sections,
+                    bool compact, bool templates);
+
+    std::unique_ptr<llvm::raw_fd_ostream> file_;
+    fmt::Formatter out_;
+    CoqPrinter print_;
+    unsigned current_{0};
+    // Indexed by section; null until the section gets an entry early.
+    std::vector<std::unique_ptr<Spill>> spills_;
+};
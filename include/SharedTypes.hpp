@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <string>
+#include <vector>
+
+namespace clang {
+class QualType;
+}
+
+class CoqPrinter;
+
+// The types of a module for [--share-types]: every distinct type that is
+// printed is defined once, as [Definition ty_k : type := ...], and referred
+// to by name. Types are told apart by their printed text, so that different
+// spellings of the same type share a definition. Types whose text is no
+// longer than their name are printed in place.
+class SharedTypes {
+public:
+    // Print [qt] to [print]. [print_type] prints its definition, the first
+    // time [qt] is seen; it may print other types through [print] itself.
+    void print(const clang::QualType& qt, CoqPrinter& print,
+               llvm::function_ref<void(CoqPrinter&)> print_type);
+
+    // Print the definitions of the types used so far, in an order where each
+    // comes after the types it refers to.
+    void print_definitions(CoqPrinter& print) const;
+
+    bool empty() const {
+        return definitions_.empty();
+    }
+
+private:
+    // What [print] prints for a type: its name or its text.
+    llvm::DenseMap<const void*, std::string> printed_;
+    llvm::StringMap<unsigned> names_;
+    std::vector<std::string> definitions_;
+};
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include <llvm/ADT/ArrayRef.h>
+#include <string>
+#include <vector>
+
+namespace clang {
+class ASTContext;
+class Decl;
+}
+
+class Module;
+
+// Restrict [mod] to what the declarations whose qualified names match one of
+// [roots] refer to, transitively, for [--roots]. Each root is a regular
+// expression that must match the whole name, so a plain qualified name
+// matches itself. Function bodies, initializers, types, and the destructor
+// and virtual functions of every class that is reached are followed; the
+// templates of the module are left alone. Return the number of declarations
+// that matched a root.
+unsigned slice_module(::Module& mod, llvm::ArrayRef<std::string> roots,
+                      clang::ASTContext& ctxt);
+
+// Add what [decl] refers to, as [slice_module] follows it, to [found].
+void references(const clang::Decl* decl,
+                std::vector<const clang::Decl*>& found);
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#pragma once
+#include <cstdint>
+#include <llvm/ADT/StringRef.h>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}
+
+// The wall-clock and CPU time that a translation unit spends in each phase
+// of cpp2v, for [--time-report].
+//
+// Phases nest (e.g. elaboration happens in the middle of the frontend), but
+// every instant is charged to the innermost phase only, so the phases add up
+// to the total. CPU time is that of the calling thread.
+class TimeReport {
+public:
+    enum Phase {
+        FRONTEND,
+        ELAB_TOP_LEVEL,
+        ELAB_TAG,
+        ELAB_SPECIALIZATION,
+        ELAB_INLINE,
+        ELAB_INSTANTIATION,
+        ELAB_ON_DEMAND,
+        BUILD_MODULE,
+        PRINT_MODULE,
+        PRINT_NAMES,
+        PRINT_TEMPLATES,
+        SAVE_DECL_CACHE,
+        PHASES,
+    };
+
+    // Time spent in [phase] for the lifetime of the scope. Does nothing if
+    // [report] is null.
+    class Scope {
+    public:
+        Scope(TimeReport* report, Phase phase);
+        ~Scope();
+
+    private:
+        TimeReport* const report_;
+        Phase outer_;
+    };
+
+    explicit TimeReport(bool json);
+
+    // Report the [hits] and [misses] of the cache called [name] along with
+    // the phases.
+    void cache(const char* name, uint64_t hits, uint64_t misses);
+
+    // Report that [n] things called [name] happened.
+    void count(const char* name, uint64_t n);
+
+    // Print the report for [file], as a table or a single line of JSON.
+    void print(llvm::raw_ostream& os, llvm::StringRef file);
+
+private:
+    struct Time {
+        uint64_t wall_ns;
+        uint64_t cpu_ns;
+    };
+
+    static Time now();
+    // Charge the time since the last switch to the current phase.
+    void charge();
+
+    const bool json_;
+    Phase current_{FRONTEND};
+    Time last_;
+    struct {
+        Time time{0, 0};
+        unsigned calls{0};
+    } phases_[PHASES];
+    struct Cache {
+        const char* name;
+        uint64_t hits;
+        uint64_t misses;
+    };
+    std::vector<Cache> caches_;
+    std::vector<std::pair<const char*, uint64_t>> counts_;
+};
@@ -5,35 +5,100 @@
  */
 #pragma once
 
+#include "TimeReport.hpp"
 #include <clang/AST/ASTConsumer.h>
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/ASTMutationListener.h>
 #include <llvm/ADT/Optional.h>
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace clang {
 class TranslationUnitDecl;
 }
 
 class CoqPrinter;
+class Elaborator;
+class FilterSpec;
+
+// The [k]th chunk of [module_file] with [--chunks], e.g. [foo_cpp_part_0.v]
+// for [foo_cpp.v].
+std::string chunk_file(llvm::StringRef module_file, unsigned k);
+
+// The mapping from interned names back to source names with
+// [--intern-names], e.g. [foo_cpp_interned.tsv] for [foo_cpp.v].
+std::string interned_names_file(llvm::StringRef module_file);
 
 namespace clang {
 class CompilerInstance;
 }
 
+// How coqc computes the module from the printed declarations
+// ([--reduction]).
+enum class Reduction {
+    // [vm_compute] on the whole list.
+    VM,
+    // [native_compute] on the whole list.
+    NATIVE,
+    // [lazy] on sub-lists of the declarations, then on their combination.
+    LAZY_PER_CHUNK,
+};
+
+// What [ToCoqConsumer] prints, and how; cpp2v.cpp fills it in from its
+// options.
+struct ToCoqOptions {
+    // The outputs, if they are printed.
+    std::optional<std::string> output_file;
+    std::optional<std::string> notations_file;
+    std::optional<std::string> templates_file;
+    // The directory of the declaration cache (see DeclCache.hpp).
+    std::optional<std::string> decl_cache;
+    // Set with [--time-report], to whether it is printed as JSON.
+    std::optional<bool> time_report_json;
+    // Where to write the JSON profile of the printed declarations, and how
+    // many of the largest ones to summarize (see DeclProfile.hpp).
+    std::optional<std::string> decl_profile;
+    unsigned decl_profile_top{0};
+    // Print [module] and [templates] with minimal whitespace.
+    bool compact{false};
+    // Print declarations as their groups are parsed (see [stream]).
+    bool stream{false};
+    // Split [module] across this many files (see [chunk_file]), or 0.
+    unsigned chunks{0};
+    // Print the tables of [module] as sorted balanced trees (see
+    // CanonicalTables.hpp).
+    bool canonical_tables{false};
+    // Define each type of [module] once (see SharedTypes.hpp).
+    bool share_types{false};
+    // Define each name of [module] once (see InternedNames.hpp).
+    bool intern_names{false};
+    Reduction reduction{Reduction::VM};
+    // Define each function body of [module] on its own (see LazyBodies.hpp).
+    bool lazy_bodies{false};
+    // The directory to print the declarations from included files to, each
+    // header on its own (see HeaderModules.hpp).
+    std::optional<std::string> header_modules;
+    // Only print what the declarations matching these patterns refer to
+    // (see Slice.hpp).
+    std::vector<std::string> roots;
+    // Which declarations to print (see FilterSpec.hpp), or everything.
+    std::shared_ptr<const FilterSpec> filter_spec;
+    // Elaborate what the main file needs once it is parsed, rather than
+    // every record as it is parsed (see [Elaborator::demand]).
+    bool lazy_elaboration{false};
+    // Define the implicit members of records at all.
+    bool elaborate{true};
+};
+
 using namespace clang;
 
 class ToCoqConsumer : public clang::ASTConsumer, clang::ASTMutationListener {
 public:
-    explicit ToCoqConsumer(clang::CompilerInstance *compiler,
-                           const std::optional<std::string> output_file,
-                           const std::optional<std::string> notations_file,
-                           const std::optional<std::string> templates_file,
-                           bool elaborate = true)
-        : compiler_(compiler), output_file_(output_file),
-          notations_file_(notations_file), templates_file_(templates_file),
-          elaborate_(elaborate) {}
+    ToCoqConsumer(clang::CompilerInstance *compiler, ToCoqOptions options);
+
+    ~ToCoqConsumer();
 
 public:
     // Implementation of `clang::ASTConsumer`
@@ -60,17 +125,37 @@ public:
         // it is not clear why this method should take a
         // `const ClassTemplateSpecializationDecl` rather than a non-`const`
         // See question: https://stackoverflow.com/questions/76085015/using-clangs-astconsumer-to-force-generation-of-implicit-members
+        TimeReport::Scope timer(timing(), TimeReport::ELAB_SPECIALIZATION);
         elab(const_cast<ClassTemplateSpecializationDecl *>(D), true);
     }
 
 private:
+    struct Printing;
+
     void toCoqModule(clang::ASTContext *ctxt, clang::TranslationUnitDecl *decl);
+    void startPrinting(clang::ASTContext *ctxt);
+    void printPending();
+    // Print the declarations of [group] that are final (for [--stream]).
+    void stream(DeclGroupRef group);
     void elab(Decl *, bool = false);
+    TimeReport *timing() {
+        return timing_.has_value() ? &*timing_ : nullptr;
+    }
+    // The name of the reduction that computes the module (see parser.v).
+    const char *reduction_name() const;
+    // With shared types, names or bodies, the definitions that go before the
+    // list of declarations are only known once it has been printed.
+    bool defer_header() const {
+        return options_.share_types or options_.intern_names or
+               options_.lazy_bodies;
+    }
 
 private:
     clang::CompilerInstance *compiler_;
-    const std::optional<std::string> output_file_;
-    const std::optional<std::string> notations_file_;
-    const std::optional<std::string> templates_file_;
-    bool elaborate_;
+    const ToCoqOptions options_;
+    // Set with [--time-report].
+    std::optional<TimeReport> timing_;
+    std::unique_ptr<Printing> printing_;
+    // Defines implicit members across the callbacks (see Elaborate.hpp).
+    std::unique_ptr<Elaborator> elaborator_;
 };
@@ -5,6 +5,14 @@
  */
 #pragma once
 
+#include <string>
+
 namespace cpp2v {
 extern const char* const VERSION;
+
+// A hash of the running executable. Unlike [VERSION], which is fixed when
+// the build is configured, it changes with every build, so caches keyed on
+// it never replay the output of another build. Empty if the executable
+// cannot be read.
+const std::string& build_id();
 }
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "CanonicalTables.hpp"
+#include "ClangPrinter.hpp"
+#include <clang/AST/Decl.h>
+#include <algorithm>
+#include <vector>
+
+static fmt::Formatter::State
+start_state(bool compact) {
+    // The entries are printed at the depth of a list element in [decls].
+    fmt::Formatter::State start;
+    start.depth = 6;
+    start.compact = compact;
+    return start;
+}
+
+CanonicalTables::CanonicalTables(bool compact)
+    : os_(text_), out_(os_, start_state(compact), 0), print_(out_, false),
+      start_(start_state(compact)) {}
+
+CoqPrinter&
+CanonicalTables::entry() {
+    out_.splice("", start_);
+    begin_ = text_.size();
+    return print_;
+}
+
+void
+CanonicalTables::add(const clang::Decl* decl, ClangPrinter& cprint) {
+    auto end = text_.size();
+    auto key = end == begin_ ? std::nullopt : key_of(decl, cprint);
+    if (not key) {
+        text_.resize(begin_);
+        return;
+    }
+    tables_[key->first].insert_or_assign(std::move(key->second),
+                                         Entry{begin_, end, out_.state()});
+}
+
+std::optional<std::pair<CanonicalTables::Table, std::string>>
+CanonicalTables::key_of(const clang::Decl* decl, ClangPrinter& cprint) {
+    using namespace clang;
+    // [Denum_constant] goes with the types, and [Dstatic_assert] nowhere.
+    if (auto ecd = dyn_cast<EnumConstantDecl>(decl)) {
+        return std::make_pair(TYPES, cprint.objName(ecd));
+    } else if (auto td = dyn_cast<TagDecl>(decl)) {
+        return std::make_pair(TYPES, cprint.typeName(td));
+    } else if (isa<FunctionDecl>(decl) or isa<VarDecl>(decl)) {
+        auto vd = cast<ValueDecl>(decl);
+        return std::make_pair(SYMBOLS, cprint.objName(vd));
+    }
+    return std::nullopt;
+}
+
+// Print the entries [begin, end) as a balanced tree, and return its height.
+template<typename I>
+static unsigned
+print_tree(CoqPrinter& print, llvm::StringRef text, I begin, I end) {
+    if (begin == end) {
+        print.output() << "table_leaf";
+        return 0;
+    }
+    auto mid = begin + (end - begin) / 2;
+    auto& key = (*mid)->first;
+    auto& entry = (*mid)->second;
+
+    print.ctor("table_node");
+    auto left = print_tree(print, text, begin, mid);
+
+    std::string lit = "\"";
+    for (auto c : key) {
+        lit += c == '"' ? "\"\"" : std::string(1, c);
+    }
+    print.output() << fmt::nbsp << lit << "\"";
+
+    // The entry starts with its own line break.
+    auto after = entry.after;
+    after.depth = print.output().state().depth;
+    print.output().splice(text.slice(entry.begin, entry.end), after);
+
+    print.output() << fmt::nbsp;
+    auto right = print_tree(print, text, mid + 1, end);
+    auto height = 1 + std::max(left, right);
+    print.output() << fmt::nbsp << height;
+    print.end_ctor();
+    return height;
+}
+
+void
+CanonicalTables::print_table(CoqPrinter& print, const char* reduction,
+                             const char* name, const char* type,
+                             const Map& table) const {
+    std::vector<const Map::value_type*> entries;
+    entries.reserve(table.size());
+    for (auto& entry : table) {
+        entries.push_back(&entry);
+    }
+
+    print.output() << fmt::line << "Definition " << name << " : IM.Raw.t "
+                   << type << " :=" << fmt::indent << fmt::line
+                   << "Eval " << reduction << " in" << fmt::nbsp;
+    print_tree(print, text_, entries.begin(), entries.end());
+    print.output() << "." << fmt::outdent << fmt::line;
+}
+
+void
+CanonicalTables::print(CoqPrinter& print, const char* reduction,
+                       const char* endian) const {
+    print_table(print, reduction, "module_symbols", "ObjValue",
+                tables_[SYMBOLS]);
+    print_table(print, reduction, "module_types", "GlobDecl", tables_[TYPES]);
+
+    // [<:] checks the order of the keys with [vm_compute].
+    print.output()
+        << fmt::line << "Definition module : translation_unit :="
+        << fmt::indent << fmt::line << "{| symbols := avl.build module_symbols"
+        << " (I <: Is_true (avl.check_canon None None module_symbols))"
+        << fmt::line << "; types := avl.build module_types"
+        << " (I <: Is_true (avl.check_canon None None module_types))"
+        << fmt::line << "; initializer := nil (* FIXME *)" << fmt::line
+        << "; byte_order := " << endian << " |}." << fmt::outdent << fmt::line;
+}
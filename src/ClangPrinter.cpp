@@ -6,6 +6,7 @@
 #include "ClangPrinter.hpp"
 #include "CoqPrinter.hpp"
 #include "Formatter.hpp"
+#include "InternedNames.hpp"
 #include "Logging.hpp"
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/DeclCXX.h>
@@ -19,9 +20,46 @@ using namespace clang;
 
 ClangPrinter::ClangPrinter(clang::CompilerInstance *compiler,
                            clang::ASTContext *context)
-    : compiler_(compiler), context_(context) {
-    mangleContext_ =
-        ItaniumMangleContext::create(*context, compiler->getDiagnostics());
+    : compiler_(compiler), context_(context),
+      mangleContext_(
+          ItaniumMangleContext::create(*context, compiler->getDiagnostics())),
+      name_cache_(std::make_shared<NameCache>()) {}
+
+// The name that [f] prints for [decl]. [f] only runs the first time [decl]
+// is looked up in [cache].
+template<typename F>
+static const std::string &
+cached_name(NameCache &cache, const NamedDecl *decl,
+            F f /* void(CoqPrinter&) */) {
+    auto it = cache.names.find(decl);
+    if (it != cache.names.end()) {
+        ++cache.hits;
+    } else {
+        ++cache.misses;
+        std::string name;
+        llvm::raw_string_ostream os(name);
+        {
+            fmt::Formatter out(os, fmt::Formatter::State{}, 0);
+            CoqPrinter name_print(out, false);
+            f(name_print);
+        }
+        os.flush();
+        it = cache.names.try_emplace(decl, std::move(name)).first;
+    }
+    return it->second;
+}
+
+// Print [name] between quotes, through [names] if the module is printed
+// with [--intern-names].
+static void
+print_name(InternedNames *names, CoqPrinter &print, const char *type,
+           const NamedDecl *decl, const std::string &name) {
+    if (names == nullptr or print.templates()) {
+        print.output() << "\"" << llvm::StringRef(name) << "\"";
+        return;
+    }
+    names->print(name, type, print,
+                 [decl] { return decl->getQualifiedNameAsString(); });
 }
 
 unsigned
@@ -303,22 +341,27 @@ printSimpleContext(const DeclContext *dc, CoqPrinter &print,
 
 void
 ClangPrinter::printTypeName(const TypeDecl *decl, CoqPrinter &print) const {
+    print_name(names_, print, "globname", decl, typeName(decl));
+}
+
+const std::string &
+ClangPrinter::typeName(const TypeDecl *decl) const {
     if (auto RD = dyn_cast<CXXRecordDecl>(decl)) {
-        print.output() << "\"";
-        printSimpleContext(RD, print, *this, *mangleContext_);
-        print.output() << "\"";
+        return cached_name(*name_cache_, decl, [&](CoqPrinter &print) {
+            printSimpleContext(RD, print, *this, *mangleContext_);
+        });
     } else if (isa<RecordDecl>(decl)) {
         // NOTE: this only matches C records, not C++ records
         // therefore, we do not perform any mangling.
-        logging::debug() << "RecordDecl: " << decl->getQualifiedNameAsString()
-                         << "\n";
-        print.output() << "\"";
-        decl->printQualifiedName(print.output().nobreak());
-        print.output() << "\"";
+        return cached_name(*name_cache_, decl, [&](CoqPrinter &print) {
+            logging::debug() << "RecordDecl: "
+                             << decl->getQualifiedNameAsString() << "\n";
+            decl->printQualifiedName(print.output().nobreak());
+        });
     } else if (auto ed = dyn_cast<EnumDecl>(decl)) {
-        print.output() << "\"";
-        printSimpleContext(ed, print, *this, *mangleContext_);
-        print.output() << "\"";
+        return cached_name(*name_cache_, decl, [&](CoqPrinter &print) {
+            printSimpleContext(ed, print, *this, *mangleContext_);
+        });
     } else {
         using namespace logging;
         fatal() << "Unknown decl kind to [printTypeName]: "
@@ -369,15 +412,58 @@ ClangPrinter::printObjName(const ValueDecl *decl, CoqPrinter &print, bool raw) {
         print.ctor("DTOR", false);
         printTypeName(dd->getParent(), print);
         print.end_ctor();
-    } else if (mangleContext_->shouldMangleDeclName(decl)) {
-        print.output() << "\"";
-        mangleContext_->mangleName(to_gd(decl), print.output().nobreak());
-        print.output() << "\"";
     } else {
-        print.output() << "\"";
-        decl->printName(print.output().nobreak());
-        print.output() << "\"";
+        print_name(names_, print, "obj_name", decl, mangledName(decl));
+    }
+}
+
+const std::string &
+ClangPrinter::mangledName(const ValueDecl *decl) {
+    if (mangleContext_->shouldMangleDeclName(decl)) {
+        return cached_name(*name_cache_, decl, [&](CoqPrinter &print) {
+            mangleContext_->mangleName(to_gd(decl), print.output().nobreak());
+        });
+    } else {
+        return cached_name(*name_cache_, decl, [&](CoqPrinter &print) {
+            decl->printName(print.output().nobreak());
+        });
+    }
+}
+
+// [parser.do_end]
+static std::string
+do_end(llvm::StringRef ty) {
+    if (ty.empty()) {
+        return "";
+    }
+    return ty.drop_back().str() + "D0Ev";
+}
+
+// [parser.DTOR]
+static std::string
+dtor_name(llvm::StringRef ty) {
+    if (ty.size() < 2) {
+        return "OOPS";
+    }
+    auto rest = ty.drop_front(2);
+    if (rest.empty()) {
+        return "_ZN";
+    } else if (rest.front() == 'N') {
+        return "_Z" + do_end(rest);
+    }
+    return "_ZN" + rest.str() + "D0Ev";
+}
+
+std::string
+ClangPrinter::objName(const ValueDecl *decl) {
+    if (auto ecd = dyn_cast<EnumConstantDecl>(decl)) {
+        // [parser.Cenum_const]
+        auto ed = cast<EnumDecl>(ecd->getDeclContext());
+        return typeName(ed) + "::" + ecd->getNameAsString();
+    } else if (auto dd = dyn_cast<CXXDestructorDecl>(decl)) {
+        return dtor_name(typeName(dd->getParent()));
     }
+    return mangledName(decl);
 }
 
 namespace {
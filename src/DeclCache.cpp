@@ -0,0 +1,569 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "DeclCache.hpp"
+#include "ClangPrinter.hpp"
+#include "CoqPrinter.hpp"
+#include "Logging.hpp"
+#include "Version.hpp"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/AST/StmtCXX.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+namespace fs = llvm::sys::fs;
+namespace path = llvm::sys::path;
+
+// The first line of a cache file. The entries follow, each as
+//   <key> <depth> <spaces> <blank> <open> <compact> <printed> <size>\n<text>
+// where the numbers describe the formatter state after [text].
+static const char MAGIC[] = "cpp2v-decl-cache 2\n";
+
+namespace {
+// The mangler numbers unnamed types and some local entities in the order in
+// which it meets them, so the text printed for a declaration that mentions
+// them depends on what was printed before it.
+bool
+unnamed(const Decl* d) {
+    auto tag = dyn_cast<TagDecl>(d);
+    if (tag == nullptr) {
+        return false;
+    }
+    if (auto rd = dyn_cast<CXXRecordDecl>(tag); rd and rd->isLambda()) {
+        return true;
+    }
+    return not tag->getIdentifier() and not tag->getTypedefNameForAnonDecl();
+}
+
+bool
+numbered(const Decl* d) {
+    // Local variables and parameters are printed by name.
+    if (auto var = dyn_cast<VarDecl>(d); var and var->hasLocalStorage()) {
+        return false;
+    }
+    if (unnamed(d) or d->getParentFunctionOrMethod() != nullptr) {
+        return true;
+    }
+    for (auto dc = d->getDeclContext(); dc; dc = dc->getParent()) {
+        if (auto tag = dyn_cast<TagDecl>(dc); tag and unnamed(tag)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Hashes everything in a declaration that its rendering depends on.
+// [ok] is false if the rendering also depends on the printing order.
+class Fingerprint : public RecursiveASTVisitor<Fingerprint> {
+public:
+    Fingerprint(const ASTContext& ctxt, llvm::MD5& hash)
+        : ctxt_(ctxt), policy_(ctxt.getPrintingPolicy()), hash_(hash) {}
+
+    bool shouldVisitImplicitCode() const {
+        return true;
+    }
+
+    bool ok() const {
+        return ok_;
+    }
+
+    void add(llvm::StringRef s) {
+        hash_.update(s);
+        hash_.update(llvm::StringRef("\0", 1));
+    }
+
+    void add(uint64_t n) {
+        uint8_t buf[8];
+        llvm::support::endian::write64le(buf, n);
+        hash_.update(buf);
+    }
+
+    void addType(QualType qt) {
+        if (qt.isNull()) {
+            add("<null>");
+            return;
+        }
+        auto canon = qt.getCanonicalType();
+        auto name = canon.getAsString(policy_);
+        if (llvm::StringRef(name).contains("(anonymous") or
+            llvm::StringRef(name).contains("(unnamed") or
+            llvm::StringRef(name).contains("(lambda")) {
+            ok_ = false;
+        }
+        add(name);
+
+        auto t = canon.getTypePtr();
+        for (;;) {
+            if (auto array = t->getAsArrayTypeUnsafe()) {
+                t = array->getElementType().getTypePtr();
+            } else if (not t->getPointeeType().isNull()) {
+                t = t->getPointeeType().getTypePtr();
+            } else {
+                break;
+            }
+        }
+        if (auto tag = t->getAsTagDecl(); tag and numbered(tag)) {
+            ok_ = false;
+        }
+    }
+
+    // Record a declaration that is referred to by name.
+    void note(const Decl* d) {
+        if (d == nullptr) {
+            add("<null>");
+            return;
+        }
+        if (numbered(d)) {
+            ok_ = false;
+        }
+        add(d->getDeclKindName());
+        if (auto nd = dyn_cast<NamedDecl>(d)) {
+            std::string name;
+            llvm::raw_string_ostream os(name);
+            nd->getNameForDiagnostic(os, policy_, true);
+            add(os.str());
+        }
+        if (auto vd = dyn_cast<ValueDecl>(d)) {
+            addType(vd->getType());
+        }
+        if (auto ecd = dyn_cast<EnumConstantDecl>(d)) {
+            llvm::SmallString<32> val;
+            ecd->getInitVal().toString(val);
+            add(val);
+        }
+        if (auto var = dyn_cast<VarDecl>(d)) {
+            add(var->hasLocalStorage());
+        }
+        // Calls print whether they dispatch virtually, which an override
+        // inherits from the method it overrides.
+        if (auto md = dyn_cast<CXXMethodDecl>(d)) {
+            add(md->isVirtual());
+        }
+    }
+
+    void source(const Decl* d) {
+        auto& sm = ctxt_.getSourceManager();
+        auto range = sm.getExpansionRange(d->getSourceRange());
+        add(Lexer::getSourceText(range, sm, ctxt_.getLangOpts()));
+    }
+
+    void header(const Decl* d) {
+        note(d);
+        source(d);
+        if (auto fd = dyn_cast<FunctionDecl>(d)) {
+            add(fd->isExternC());
+            add(fd->getStorageClass());
+            add(fd->isVariadic());
+            add(fd->isDefaulted());
+            add(fd->isDeleted());
+            add(fd->getBuiltinID());
+            add(fd->getTemplateSpecializationKind());
+            if (auto ft = fd->getType()->getAs<FunctionType>()) {
+                add(ft->getCallConv());
+            }
+            if (auto md = dyn_cast<CXXMethodDecl>(fd)) {
+                add(md->isStatic());
+                add(md->isVirtual());
+            }
+            if (auto tmpl = fd->getPrimaryTemplate()) {
+                note(tmpl);
+            }
+        } else if (auto var = dyn_cast<VarDecl>(d)) {
+            add(var->hasInit());
+            add(var->isTemplated());
+        }
+    }
+
+    bool VisitStmt(Stmt* s) {
+        add(s->getStmtClassName());
+        return true;
+    }
+
+    bool VisitExpr(Expr* e) {
+        addType(e->getType());
+        add(e->getValueKind());
+        return true;
+    }
+
+    bool VisitCastExpr(CastExpr* e) {
+        add(e->getCastKind());
+        return true;
+    }
+
+    bool VisitBinaryOperator(BinaryOperator* e) {
+        add(e->getOpcode());
+        return true;
+    }
+
+    bool VisitUnaryOperator(UnaryOperator* e) {
+        add(e->getOpcode());
+        return true;
+    }
+
+    bool VisitCXXOperatorCallExpr(CXXOperatorCallExpr* e) {
+        add(e->getOperator());
+        return true;
+    }
+
+    bool VisitIntegerLiteral(IntegerLiteral* e) {
+        llvm::SmallString<32> val;
+        e->getValue().toStringUnsigned(val);
+        add(val);
+        return true;
+    }
+
+    bool VisitCharacterLiteral(CharacterLiteral* e) {
+        add(e->getValue());
+        add(e->getKind());
+        return true;
+    }
+
+    bool VisitFloatingLiteral(FloatingLiteral* e) {
+        llvm::SmallString<32> val;
+        e->getValue().bitcastToAPInt().toStringUnsigned(val, 16);
+        add(val);
+        return true;
+    }
+
+    bool VisitStringLiteral(StringLiteral* e) {
+        add(e->getBytes());
+        add(e->getKind());
+        add(e->getCharByteWidth());
+        return true;
+    }
+
+    bool VisitCXXBoolLiteralExpr(CXXBoolLiteralExpr* e) {
+        add(e->getValue());
+        return true;
+    }
+
+    bool VisitDeclRefExpr(DeclRefExpr* e) {
+        note(e->getDecl());
+        return true;
+    }
+
+    bool VisitMemberExpr(MemberExpr* e) {
+        note(e->getMemberDecl());
+        add(e->isArrow());
+        return true;
+    }
+
+    bool VisitCXXConstructExpr(CXXConstructExpr* e) {
+        note(e->getConstructor());
+        add(e->getConstructionKind());
+        add(e->isElidable());
+        add(e->requiresZeroInitialization());
+        return true;
+    }
+
+    bool VisitCXXNewExpr(CXXNewExpr* e) {
+        note(e->getOperatorNew());
+        note(e->getOperatorDelete());
+        add(e->isArray());
+        add(e->isGlobalNew());
+        return true;
+    }
+
+    bool VisitCXXDeleteExpr(CXXDeleteExpr* e) {
+        note(e->getOperatorDelete());
+        add(e->isArrayForm());
+        add(e->isGlobalDelete());
+        return true;
+    }
+
+    bool VisitCXXBindTemporaryExpr(CXXBindTemporaryExpr* e) {
+        note(e->getTemporary()->getDestructor());
+        return true;
+    }
+
+    // The printer descends into default arguments and member initializers,
+    // which live in other declarations.
+    bool VisitCXXDefaultArgExpr(CXXDefaultArgExpr* e) {
+        return TraverseStmt(e->getExpr());
+    }
+
+    bool VisitCXXDefaultInitExpr(CXXDefaultInitExpr* e) {
+        return TraverseStmt(e->getExpr());
+    }
+
+    bool VisitUnaryExprOrTypeTraitExpr(UnaryExprOrTypeTraitExpr* e) {
+        add(e->getKind());
+        if (e->isArgumentType()) {
+            addType(e->getArgumentType());
+        }
+        return true;
+    }
+
+    bool VisitTypeTraitExpr(TypeTraitExpr* e) {
+        add(e->getTrait());
+        if (not e->isValueDependent()) {
+            add(e->getValue());
+        }
+        return true;
+    }
+
+    bool VisitCXXNoexceptExpr(CXXNoexceptExpr* e) {
+        if (not e->isValueDependent()) {
+            add(e->getValue());
+        }
+        return true;
+    }
+
+    bool VisitPredefinedExpr(PredefinedExpr* e) {
+        add(e->getIdentKind());
+        return true;
+    }
+
+    bool VisitOffsetOfExpr(OffsetOfExpr* e) {
+        for (unsigned i = 0; i < e->getNumComponents(); ++i) {
+            auto comp = e->getComponent(i);
+            add(comp.getKind());
+            if (comp.getKind() == OffsetOfNode::Field) {
+                note(comp.getField());
+            }
+        }
+        return true;
+    }
+
+    // Case labels are printed as their values.
+    bool VisitCaseStmt(CaseStmt* s) {
+        for (auto e : {s->getLHS(), s->getRHS()}) {
+            if (e and not e->isValueDependent()) {
+                llvm::SmallString<32> val;
+                e->EvaluateKnownConstInt(ctxt_).toString(val);
+                add(val);
+            }
+        }
+        return true;
+    }
+
+    bool VisitLabelStmt(LabelStmt* s) {
+        add(s->getName());
+        return true;
+    }
+
+    bool VisitGotoStmt(GotoStmt* s) {
+        add(s->getLabel()->getName());
+        return true;
+    }
+
+    bool VisitGCCAsmStmt(GCCAsmStmt* s) {
+        add(s->getAsmString()->getString());
+        add(s->isVolatile());
+        for (unsigned i = 0; i < s->getNumInputs(); ++i) {
+            add(s->getInputConstraint(i));
+        }
+        for (unsigned i = 0; i < s->getNumOutputs(); ++i) {
+            add(s->getOutputConstraint(i));
+        }
+        for (unsigned i = 0; i < s->getNumClobbers(); ++i) {
+            add(s->getClobber(i));
+        }
+        return true;
+    }
+
+    bool VisitAttributedStmt(AttributedStmt* s) {
+        for (auto attr : s->getAttrs()) {
+            add(attr->getSpelling());
+        }
+        return true;
+    }
+
+    bool VisitVarDecl(VarDecl* d) {
+        note(d);
+        add(d->getStorageClass());
+        add(d->isStaticLocal());
+        return true;
+    }
+
+    bool TraverseConstructorInitializer(CXXCtorInitializer* init) {
+        add(init->isDelegatingInitializer());
+        if (auto base = init->getBaseClass()) {
+            addType(QualType(base, 0));
+        }
+        if (auto im = init->getIndirectMember()) {
+            for (auto i : im->chain()) {
+                note(i);
+            }
+        } else if (auto m = init->getMember()) {
+            note(m);
+        }
+        return RecursiveASTVisitor::TraverseConstructorInitializer(init);
+    }
+
+private:
+    const ASTContext& ctxt_;
+    const PrintingPolicy policy_;
+    llvm::MD5& hash_;
+    bool ok_{true};
+};
+} // namespace
+
+DeclCache::DeclCache(llvm::StringRef dir, const ASTContext& ctxt)
+    : ctxt_(ctxt) {
+    auto& sm = ctxt.getSourceManager();
+    llvm::SmallString<256> main;
+    if (auto fe = sm.getFileEntryForID(sm.getMainFileID())) {
+        main = fe->tryGetRealPathName();
+        if (main.empty()) {
+            main = fe->getName();
+        }
+    }
+    llvm::MD5 hash;
+    hash.update(main);
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    llvm::SmallString<256> file(dir);
+    path::append(file, result.digest());
+    file_ = std::string(file.str());
+
+    auto buf = llvm::MemoryBuffer::getFile(file_);
+    if (not buf) {
+        return;
+    }
+    auto data = (*buf)->getBuffer();
+    if (not data.consume_front(MAGIC)) {
+        return;
+    }
+    while (not data.empty()) {
+        auto [line, rest] = data.split('\n');
+        llvm::SmallVector<llvm::StringRef, 8> fields;
+        line.split(fields, ' ');
+        unsigned depth, spaces, blank, open, compact, printed;
+        size_t size;
+        if (fields.size() != 8 or fields[1].getAsInteger(10, depth) or
+            fields[2].getAsInteger(10, spaces) or
+            fields[3].getAsInteger(10, blank) or
+            fields[4].getAsInteger(10, open) or
+            fields[5].getAsInteger(10, compact) or
+            fields[6].getAsInteger(10, printed) or
+            fields[7].getAsInteger(10, size) or rest.size() < size) {
+            logging::log() << "cpp2v: ignoring corrupt declaration cache "
+                           << file_ << "\n";
+            old_.clear();
+            return;
+        }
+        old_[fields[0]] = Entry{rest.take_front(size).str(),
+                                {depth, spaces, blank != 0, open != 0,
+                                 compact != 0},
+                                printed != 0};
+        data = rest.drop_front(size);
+    }
+}
+
+std::optional<std::string>
+DeclCache::fingerprint(const Decl* decl, fmt::Formatter::State state,
+                       bool templates) const {
+    // Function bodies and variable initializers are where the bulk of the
+    // output comes from.
+    if (not isa<FunctionDecl>(decl) and not isa<VarDecl>(decl)) {
+        return std::nullopt;
+    }
+
+    llvm::MD5 hash;
+    Fingerprint fp(ctxt_, hash);
+    fp.add(cpp2v::VERSION);
+    fp.add(cpp2v::build_id());
+    fp.add(ctxt_.getTargetInfo().getTriple().str());
+    fp.add(templates);
+    fp.add(state.depth);
+    fp.add(state.spaces);
+    fp.add(state.blank);
+    fp.add(state.open);
+    fp.add(state.compact);
+
+    fp.header(decl);
+    fp.TraverseDecl(const_cast<Decl*>(decl));
+    // The body is printed with every declaration of the function.
+    const FunctionDecl* def = nullptr;
+    if (auto fd = dyn_cast<FunctionDecl>(decl);
+        fd and fd->hasBody(def) and def != fd) {
+        fp.source(def);
+        fp.TraverseDecl(const_cast<FunctionDecl*>(def));
+    }
+    if (not fp.ok()) {
+        return std::nullopt;
+    }
+
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    return std::string(result.digest().str());
+}
+
+bool
+DeclCache::printDecl(const Decl* decl, CoqPrinter& print,
+                     ClangPrinter& cprint) {
+    auto& out = print.output();
+    auto key = fingerprint(decl, out.state(), print.templates());
+    if (not key) {
+        return cprint.printDecl(decl, print);
+    }
+
+    auto i = new_.find(*key);
+    if (i == new_.end()) {
+        auto j = old_.find(*key);
+        if (j != old_.end()) {
+            i = new_.try_emplace(*key, std::move(j->second)).first;
+        }
+    }
+    if (i != new_.end()) {
+        ++hits_;
+        out.splice(i->second.text, i->second.after);
+        return i->second.printed;
+    }
+
+    ++misses_;
+    std::string text;
+    llvm::raw_string_ostream os(text);
+    fmt::Formatter fmt(os, out.state(), 0);
+    CoqPrinter sub(fmt, print.templates());
+    bool printed = cprint.printDecl(decl, sub);
+    os.flush();
+    out.splice(text, fmt.state());
+    new_.try_emplace(*key, Entry{std::move(text), fmt.state(), printed});
+    return printed;
+}
+
+void
+DeclCache::save() const {
+    // Write a fresh file and move it into place, so that an interrupted run
+    // never leaves a truncated cache behind.
+    llvm::SmallString<256> tmp;
+    int fd;
+    if (fs::create_directories(path::parent_path(file_)) or
+        fs::createUniqueFile(file_ + ".tmp%%%%%%", fd, tmp)) {
+        logging::log() << "cpp2v: cannot write declaration cache " << file_
+                       << "\n";
+        return;
+    }
+    {
+        llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+        os << MAGIC;
+        for (auto& entry : new_) {
+            auto& e = entry.getValue();
+            os << entry.getKey() << " " << e.after.depth << " "
+               << e.after.spaces << " " << e.after.blank << " "
+               << e.after.open << " " << e.after.compact << " " << e.printed
+               << " " << e.text.size() << "\n"
+               << e.text;
+        }
+    }
+    if (fs::rename(tmp, file_)) {
+        fs::remove(tmp);
+    }
+}
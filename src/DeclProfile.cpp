@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "DeclProfile.hpp"
+#include "Formatter.hpp"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+
+DeclProfile::Start
+DeclProfile::start(const fmt::Formatter& out) const {
+    return Start{out.tell(), std::chrono::steady_clock::now()};
+}
+
+void
+DeclProfile::record(const Decl* decl, const fmt::Formatter& out,
+                    bool templates, const Start& start) {
+    auto elapsed = std::chrono::steady_clock::now() - start.time;
+
+    std::string name;
+    if (auto nd = dyn_cast<NamedDecl>(decl)) {
+        llvm::raw_string_ostream os(name);
+        nd->getNameForDiagnostic(os, ctxt_.getPrintingPolicy(), true);
+        os.flush();
+    }
+    auto loc = ctxt_.getSourceManager().getPresumedLoc(decl->getLocation());
+    std::string location;
+    if (loc.isValid()) {
+        llvm::raw_string_ostream os(location);
+        os << loc.getFilename() << ":" << loc.getLine() << ":"
+           << loc.getColumn();
+        os.flush();
+    }
+
+    records_.push_back(
+        Record{std::move(name), decl->getDeclKindName(), std::move(location),
+               templates, out.tell() - start.offset,
+               std::chrono::duration<double>(elapsed).count()});
+}
+
+void
+DeclProfile::write(llvm::raw_ostream& os, llvm::StringRef file) const {
+    llvm::json::OStream json(os, 1);
+    json.object([&] {
+        json.attribute("file", file);
+        json.attributeArray("decls", [&] {
+            for (auto& r : records_) {
+                json.object([&] {
+                    json.attribute("name", r.name);
+                    json.attribute("kind", r.kind);
+                    json.attribute("location", r.location);
+                    json.attribute("output", r.templates ? "templates"
+                                                         : "module");
+                    json.attribute("bytes", int64_t(r.bytes));
+                    json.attribute("seconds", r.seconds);
+                });
+            }
+        });
+    });
+    os << "\n";
+}
+
+void
+DeclProfile::print_top(llvm::raw_ostream& os, unsigned n) const {
+    std::vector<const Record*> top;
+    for (auto& r : records_) {
+        top.push_back(&r);
+    }
+    n = std::min<size_t>(n, top.size());
+    std::partial_sort(top.begin(), top.begin() + n, top.end(),
+                      [](auto a, auto b) { return a->bytes > b->bytes; });
+
+    uint64_t total = 0;
+    for (auto& r : records_) {
+        total += r.bytes;
+    }
+    os << "===== cpp2v largest declarations (" << total << " bytes in "
+       << records_.size() << " declarations) =====\n"
+       << "     Bytes  Time (ms)  Declaration\n";
+    for (unsigned i = 0; i < n; ++i) {
+        auto r = top[i];
+        os << llvm::format("%10llu %10.3f", (unsigned long long)r->bytes,
+                           r->seconds * 1e3)
+           << "  " << (r->name.empty() ? r->kind : r->name);
+        if (not r->location.empty()) {
+            os << " (" << r->location << ")";
+        }
+        os << "\n";
+    }
+}
@@ -4,17 +4,20 @@
  * See the LICENSE-BedRock file in the repository root for details.
  */
 #include "DeclVisitorWithArgs.h"
+#include "Elaborate.hpp"
 #include "Filter.hpp"
 #include "Formatter.hpp"
 #include "FromClang.hpp"
 #include "Logging.hpp"
 #include "ModuleBuilder.hpp"
+#include "Slice.hpp"
 #include "SpecCollector.hpp"
 #include "ToCoq.hpp"
 #include "clang/Basic/Builtins.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Sema/Sema.h"
-#include <set>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 
 using namespace clang;
 
@@ -32,19 +35,50 @@ private:
     using Visitor = DeclVisitorArgs<Elaborate, void, Flags>;
 
     clang::CompilerInstance *const ci_;
-    std::set<int64_t> visited_;
+    // The declarations elaborated so far, and whether with their members.
+    llvm::DenseMap<const Decl *, bool> visited_;
+    // The records whose implicit members have been declared.
+    llvm::DenseSet<const CXXRecordDecl *> generated_;
+    unsigned defined_{0};
     const bool templates_;
-    bool recursive_;
+    bool recursive_{false};
 
 public:
-    Elaborate(clang::CompilerInstance *ci, bool templates, bool rec = false)
-        : ci_(ci), templates_(templates), recursive_(rec) {}
+    Elaborate(clang::CompilerInstance *ci, bool templates)
+        : ci_(ci), templates_(templates) {}
+
+    bool elaborated(const Decl *d, bool recursive) const {
+        auto it = visited_.find(d);
+        return it != visited_.end() and (it->second or not recursive);
+    }
+
+    void run(Decl *d, bool recursive, Flags flags) {
+        recursive_ = recursive;
+        Visit(d, flags);
+    }
+
+    unsigned declarations() const {
+        return visited_.size();
+    }
+
+    unsigned defined() const {
+        return defined_;
+    }
+
+    Sema &sema() const {
+        return ci_->getSema();
+    }
 
     void Visit(Decl *d, Flags flags) {
-        if (visited_.find(d->getID()) == visited_.end()) {
-            visited_.insert(d->getID());
-            Visitor::Visit(d, flags);
+        if (elaborated(d, recursive_)) {
+            return;
+        }
+        // A tag that is not complete yet is elaborated again once it is.
+        auto tag = dyn_cast<TagDecl>(d);
+        if (tag == nullptr or tag->isCompleteDefinition()) {
+            visited_[d] = recursive_;
         }
+        Visitor::Visit(d, flags);
     }
 
     void VisitDecl(const Decl *d, Flags) {
@@ -83,7 +117,7 @@ public:
             return;
         }
 
-        if (decl->isCompleteDefinition()) {
+        if (decl->isCompleteDefinition() and generated_.insert(decl).second) {
             // Do *not* generate deprecated members
             GenerateImplicitMembers(decl, false);
         }
@@ -104,10 +138,12 @@ public:
             if (decl->isMoveAssignmentOperator()) {
                 ci_->getSema().DefineImplicitMoveAssignment(decl->getLocation(),
                                                             decl);
+                ++defined_;
 
             } else if (decl->isCopyAssignmentOperator()) {
                 ci_->getSema().DefineImplicitCopyAssignment(decl->getLocation(),
                                                             decl);
+                ++defined_;
             } else {
                 logging::log() << "Didn't generate body for defaulted method\n";
             }
@@ -138,12 +174,15 @@ public:
             if (decl->isDefaultConstructor()) {
                 ci_->getSema().DefineImplicitDefaultConstructor(
                     decl->getLocation(), decl);
+                ++defined_;
             } else if (decl->isCopyConstructor()) {
                 ci_->getSema().DefineImplicitCopyConstructor(
                     decl->getLocation(), decl);
+                ++defined_;
             } else if (decl->isMoveConstructor()) {
                 ci_->getSema().DefineImplicitMoveConstructor(
                     decl->getLocation(), decl);
+                ++defined_;
             } else {
                 logging::debug() << "Unknown defaulted constructor.\n";
             }
@@ -156,6 +195,7 @@ public:
 
         if (not decl->hasBody() && decl->isDefaulted()) {
             ci_->getSema().DefineImplicitDestructor(decl->getLocation(), decl);
+            ++defined_;
         }
     }
 
@@ -179,40 +219,163 @@ public:
     }
 };
 
+Elaborator::Elaborator(clang::CompilerInstance *ci, bool templates)
+    : elab_(std::make_unique<Elaborate>(ci, templates)) {}
+
+Elaborator::~Elaborator() = default;
+
+void
+Elaborator::add(Decl *decl, bool recursive) {
+    if (elab_->elaborated(decl, recursive)) {
+        return;
+    }
+    worklist_.emplace_back(decl, recursive);
+    // Defining an implicit member can instantiate templates, which calls
+    // back into [add]; the outermost call gets to those.
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    for (size_t i = 0; i < worklist_.size(); ++i) {
+        auto [d, rec] = worklist_[i];
+        elab_->run(d, rec, Flags{false, false});
+    }
+    worklist_.clear();
+    running_ = false;
+}
+
+// Add the declarations in [dc] that [BuildModule] visits, or nested in
+// them, to [found], with the specializations of their templates.
+static void
+module_decls(const DeclContext *dc, std::vector<const Decl *> &found) {
+    for (auto d : dc->decls()) {
+        if (isa<NamespaceDecl>(d) or isa<LinkageSpecDecl>(d)) {
+            module_decls(cast<DeclContext>(d), found);
+            continue;
+        }
+        found.push_back(d);
+        if (auto ct = dyn_cast<ClassTemplateDecl>(d)) {
+            for (auto i : ct->specializations()) {
+                found.push_back(i);
+                module_decls(i, found);
+            }
+        } else if (auto ft = dyn_cast<FunctionTemplateDecl>(d)) {
+            for (auto i : ft->specializations()) {
+                found.push_back(i);
+            }
+        } else if (auto vt = dyn_cast<VarTemplateDecl>(d)) {
+            for (auto i : vt->specializations()) {
+                found.push_back(i);
+            }
+        } else if (auto rd = dyn_cast<CXXRecordDecl>(d)) {
+            module_decls(rd, found);
+        }
+    }
+}
+
+void
+Elaborator::demand(const TranslationUnitDecl *tu, Filter &filter) {
+    auto &sema = elab_->sema();
+    // The roots are what [BuildModule] prints as definitions, wherever they
+    // are written: [filter] decides, below.
+    std::vector<const Decl *> roots;
+    module_decls(tu, roots);
+
+    // Defining implicit members can need templates instantiated, which Sema
+    // has otherwise already done by now. The bodies that this instantiates
+    // can refer to more records, so walk again until that reaches nothing
+    // new.
+    for (size_t last = 0;;) {
+        std::vector<const Decl *> work(roots);
+        llvm::DenseSet<const Decl *> reached;
+        while (not work.empty()) {
+            auto decl = work.back()->getCanonicalDecl();
+            work.pop_back();
+            if (not reached.insert(decl).second) {
+                continue;
+            }
+            if (auto dc = dyn_cast<DeclContext>(decl)) {
+                if (dc->isDependentContext()) {
+                    continue;
+                }
+            }
+            if (filter.shouldInclude(decl) != Filter::What::DEFINITION) {
+                continue;
+            }
+            if (auto rd = dyn_cast<CXXRecordDecl>(decl)) {
+                if (auto def = rd->getDefinition()) {
+                    add(def, true);
+                }
+            }
+            references(decl, work);
+        }
+        bool pending = not sema.PendingInstantiations.empty() or
+                       not sema.PendingLocalImplicitInstantiations.empty();
+        if (pending) {
+            sema.PerformPendingInstantiations();
+        }
+        if (not pending or reached.size() == last) {
+            return;
+        }
+        last = reached.size();
+    }
+}
+
+unsigned
+Elaborator::declarations() const {
+    return elab_->declarations();
+}
+
+unsigned
+Elaborator::implicit_members() const {
+    return elab_->defined();
+}
+
 void
 ToCoqConsumer::elab(Decl *d, bool rec) {
-    Flags f{false, false};
-    if (auto dc = dyn_cast<DeclContext>(d)) {
-        f.in_template = dc->isDependentContext();
+    // See [toCoqModule].
+    if (options_.lazy_elaboration) {
+        return;
     }
-    if (not f.in_template) {
-        Elaborate(compiler_, templates_file_.has_value(), rec).Visit(d, f);
+    if (auto dc = dyn_cast<DeclContext>(d)) {
+        if (dc->isDependentContext()) {
+            return;
+        }
     }
+    elaborator_->add(d, rec);
 }
 
 bool
 ToCoqConsumer::HandleTopLevelDecl(DeclGroupRef decl) {
-    if (elaborate_) {
+    TimeReport::Scope timer(timing(), TimeReport::ELAB_TOP_LEVEL);
+    if (options_.elaborate) {
         for (auto i : decl) {
             elab(i, true);
         }
     }
+    if (options_.stream and
+        not compiler_->getDiagnostics().hasErrorOccurred()) {
+        stream(decl);
+    }
     return true;
 }
 
 void
 ToCoqConsumer::HandleCXXImplicitFunctionInstantiation(FunctionDecl *decl) {
+    TimeReport::Scope timer(timing(), TimeReport::ELAB_INSTANTIATION);
     elab(decl);
 }
 
 void
 ToCoqConsumer::HandleInlineFunctionDefinition(FunctionDecl *decl) {
+    TimeReport::Scope timer(timing(), TimeReport::ELAB_INLINE);
     elab(decl);
 }
 
 void
 ToCoqConsumer::HandleTagDeclDefinition(TagDecl *decl) {
-    if (elaborate_) {
+    TimeReport::Scope timer(timing(), TimeReport::ELAB_TAG);
+    if (options_.elaborate) {
         elab(decl);
     }
 }
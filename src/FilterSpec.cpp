@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "FilterSpec.hpp"
+#include "clang/AST/Decl.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/Error.h"
+
+std::optional<FilterSpec>
+FilterSpec::parse(llvm::StringRef text, std::string& error) {
+    FilterSpec spec;
+    unsigned number = 0;
+    while (not text.empty()) {
+        llvm::StringRef line;
+        std::tie(line, text) = text.split('\n');
+        ++number;
+        line = line.trim();
+        if (line.empty() or line.startswith("#")) {
+            continue;
+        }
+        auto fail = [&](const llvm::Twine& message) {
+            error = (llvm::Twine(number) + ": " + message).str();
+            return std::nullopt;
+        };
+
+        llvm::StringRef action, kind, pattern;
+        std::tie(action, line) = llvm::getToken(line);
+        std::tie(kind, pattern) = llvm::getToken(line);
+        pattern = pattern.trim();
+
+        Rule rule;
+        auto what = llvm::StringSwitch<std::optional<Filter::What>>(action)
+                        .Case("definition", Filter::What::DEFINITION)
+                        .Case("declaration", Filter::What::DECLARATION)
+                        .Case("exclude", Filter::What::NOTHING)
+                        .Default(std::nullopt);
+        if (not what) {
+            return fail("unknown action '" + action +
+                        "' (expected definition, declaration or exclude)");
+        }
+        rule.what = *what;
+        auto k = llvm::StringSwitch<std::optional<Kind>>(kind)
+                     .Case("path", PATH)
+                     .Case("namespace", NAMESPACE)
+                     .Case("name", NAME)
+                     .Default(std::nullopt);
+        if (not k) {
+            return fail("unknown kind '" + kind +
+                        "' (expected path, namespace or name)");
+        }
+        rule.kind = *k;
+
+        if (rule.kind == NAME) {
+            rule.regex =
+                std::make_shared<llvm::Regex>(("^(" + pattern + ")$").str());
+            std::string message;
+            if (not rule.regex->isValid(message)) {
+                return fail("invalid pattern '" + pattern + "': " + message);
+            }
+        } else {
+            auto glob = llvm::GlobPattern::create(pattern);
+            if (not glob) {
+                return fail("invalid pattern '" + pattern +
+                            "': " + llvm::toString(glob.takeError()));
+            }
+            rule.glob.emplace(std::move(*glob));
+        }
+        spec.rules_.push_back(std::move(rule));
+    }
+    return spec;
+}
+
+int
+SpecFilter::last_match(FilterSpec::Kind kind, llvm::StringRef text) const {
+    auto& rules = spec_.rules();
+    for (int i = int(rules.size()) - 1; 0 <= i; --i) {
+        if (rules[i].kind == kind and rules[i].glob->match(text)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+Filter::What
+SpecFilter::shouldInclude(const Decl* d) {
+    auto& rules = spec_.rules();
+
+    // Like [NoInclude], use the presumed name of the file, which [#line]
+    // can change within a file.
+    auto loc = sm_.getExpansionLoc(d->getLocation());
+    auto ploc = loc.isValid() ? sm_.getPresumedLoc(loc) : PresumedLoc();
+    llvm::StringRef file = ploc.isValid() ? ploc.getFilename() : "";
+    auto by_file = by_file_.find(file);
+    if (by_file == by_file_.end()) {
+        auto match = ploc.isValid() ? last_match(FilterSpec::PATH, file) : -1;
+        by_file = by_file_.try_emplace(file, match).first;
+    }
+
+    auto ns = d->getDeclContext()->getEnclosingNamespaceContext();
+    auto by_namespace = by_namespace_.find(ns);
+    if (by_namespace == by_namespace_.end()) {
+        std::string name;
+        if (auto nd = dyn_cast<NamespaceDecl>(ns)) {
+            name = nd->getQualifiedNameAsString();
+        }
+        auto match = last_match(FilterSpec::NAMESPACE, name);
+        by_namespace = by_namespace_.try_emplace(ns, match).first;
+    }
+
+    int match = std::max(by_file->second, by_namespace->second);
+    std::optional<std::string> name;
+    for (int i = int(rules.size()) - 1; match < i; --i) {
+        if (rules[i].kind != FilterSpec::NAME) {
+            continue;
+        }
+        auto nd = dyn_cast<NamedDecl>(d);
+        if (not nd) {
+            break;
+        }
+        if (not name) {
+            name = nd->getQualifiedNameAsString();
+        }
+        if (rules[i].regex->match(*name)) {
+            match = i;
+        }
+    }
+    return match < 0 ? What::DEFINITION : rules[match].what;
+}
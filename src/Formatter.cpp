@@ -11,39 +11,95 @@
 
 namespace fmt {
 
+ChunkedStream::ChunkedStream(llvm::raw_ostream& out, size_t buffer_size)
+    : out_(out) {
+    if (buffer_size == 0) {
+        SetUnbuffered();
+    } else {
+        SetBufferSize(buffer_size);
+    }
+}
+
+ChunkedStream::~ChunkedStream() {
+    flush();
+}
+
+void
+ChunkedStream::write_impl(const char* ptr, size_t size) {
+    out_.write(ptr, size);
+    pos_ += size;
+}
+
 Formatter::Formatter() : Formatter(llvm::outs()) {}
 
-Formatter::Formatter(llvm::raw_ostream& _out)
-    : out(_out), depth(0), spaces(0), blank(true) {}
+Formatter::Formatter(llvm::raw_ostream& _out, size_t buffer_size)
+    : Formatter(_out, State{}, buffer_size) {}
+
+Formatter::Formatter(llvm::raw_ostream& _out, State state, size_t buffer_size)
+    : out(_out, buffer_size), depth(state.depth), spaces(state.spaces),
+      blank(state.blank), open(state.open), compact(state.compact) {}
 
 llvm::raw_ostream&
 Formatter::line() {
-    out << "\n";
+    if (compact and depth > COMPACT_DEPTH) {
+        // Only a token separator.
+        spaces = 1;
+        return out;
+    }
+    out << '\n';
     blank = true;
     spaces = 0;
+    glue();
     return out;
 }
 
 llvm::raw_ostream&
 Formatter::nobreak() {
-    if (blank) {
-        for (unsigned int d = this->depth; d > 0; --d) {
-            out << " ";
+    if (compact) {
+        if (spaces > 0 and not open) {
+            out << ' ';
         }
+        spaces = 0;
         blank = false;
+        open = false;
+        return out;
     }
-    while (spaces > 0) {
-        out << " ";
-        spaces--;
+    // [raw_ostream::indent] copies the spaces from a static slab.
+    unsigned int pad = spaces;
+    if (blank) {
+        pad += depth;
+        blank = false;
+    }
+    if (pad > 0) {
+        out.indent(pad);
+        spaces = 0;
     }
     return out;
 }
 
+void
+Formatter::splice(llvm::StringRef text, State after) {
+    out << text;
+    depth = after.depth;
+    spaces = after.spaces;
+    blank = after.blank;
+    open = after.open;
+    compact = after.compact;
+}
+
 void
 Formatter::nbsp() {
     spaces++;
 }
 
+void
+Formatter::glue() {
+    if (compact) {
+        spaces = 0;
+        open = true;
+    }
+}
+
 void
 Formatter::indent() {
     this->depth += 2;
@@ -54,13 +110,27 @@ Formatter::outdent() {
     this->depth -= 2;
 }
 
+void
+Formatter::lparen() {
+    nobreak() << '(';
+    indent();
+    glue();
+}
+
+void
+Formatter::rparen() {
+    outdent();
+    glue();
+    nobreak() << ')';
+}
+
 void
 Formatter::ascii(int val) {
-    out << "\"";
-    out << (char)((val >> 6) + '0');
-    out << (char)(((val >> 3) & 0x7) + '0');
-    out << (char)((val & 0x7) + '0');
-    out << "\"";
+    const char buf[] = {'"', (char)((val >> 6) + '0'),
+                        (char)(((val >> 3) & 0x7) + '0'),
+                        (char)((val & 0x7) + '0'), '"'};
+    out.write(buf, sizeof(buf));
+    open = false;
 }
 
 Formatter Formatter::default_output = Formatter();
@@ -96,8 +166,7 @@ struct LPAREN;
 const LPAREN* lparen;
 Formatter&
 operator<<(Formatter& out, const LPAREN* _) {
-    out.nobreak() << "(";
-    out.indent();
+    out.lparen();
     return out;
 }
 
@@ -105,8 +174,7 @@ struct RPAREN;
 const RPAREN* rparen;
 Formatter&
 operator<<(Formatter& out, const RPAREN* _) {
-    out.outdent();
-    out.nobreak() << ")";
+    out.rparen();
     return out;
 }
 
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "HeaderModules.hpp"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/xxhash.h"
+
+using namespace clang;
+
+HeaderModules::HeaderModules(const SourceManager& sm, std::string dir,
+                             bool compact)
+    : sm_(sm), dir_(std::move(dir)), compact_(compact) {}
+
+HeaderModules::~HeaderModules() = default;
+
+// Whether [decl] is printed the same way by every translation unit that
+// includes it.
+static bool
+is_shareable(const Decl* decl) {
+    if (decl->isImplicit()) {
+        return false;
+    }
+    if (auto fd = dyn_cast<FunctionDecl>(decl)) {
+        return fd->getTemplateSpecializationKind() == TSK_Undeclared;
+    }
+    if (auto rd = dyn_cast<CXXRecordDecl>(decl)) {
+        return not isa<ClassTemplateSpecializationDecl>(rd) and
+               rd->getTemplateSpecializationKind() == TSK_Undeclared;
+    }
+    if (auto vd = dyn_cast<VarDecl>(decl)) {
+        return vd->getTemplateSpecializationKind() == TSK_Undeclared;
+    }
+    return true;
+}
+
+CoqPrinter*
+HeaderModules::entry(const Decl* decl) {
+    if (not is_shareable(decl)) {
+        return nullptr;
+    }
+    // Like [NoInclude], attribute declarations by their presumed location.
+    auto loc = sm_.getPresumedLoc(decl->getLocation());
+    if (loc.isInvalid() or not loc.getIncludeLoc().isValid()) {
+        return nullptr;
+    }
+    auto& header = index_[loc.getFilename()];
+    if (not header) {
+        // The entries are printed at the depth of a list element in
+        // [decls].
+        fmt::Formatter::State start;
+        start.depth = 1;
+        start.compact = compact_;
+        headers_.push_back(
+            std::make_unique<Header>(loc.getFilename(), start));
+        header = headers_.back().get();
+    }
+    return &header->print;
+}
+
+// [h_<file name>_<hash>], with the characters that Coq does not accept in
+// module names replaced.
+static std::string
+module_name(llvm::StringRef file, llvm::StringRef text) {
+    std::string name = "h_";
+    for (auto c : llvm::sys::path::filename(file)) {
+        name += isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    llvm::raw_string_ostream os(name);
+    os << "_" << llvm::format_hex_no_prefix(llvm::xxHash64(text), 16);
+    return os.str();
+}
+
+std::vector<std::string>
+HeaderModules::write(const char* reduction, const char* endian) {
+    std::vector<std::string> names;
+    for (auto& header : headers_) {
+        std::string text;
+        llvm::raw_string_ostream os(text);
+        os << "Require Import bedrock.lang.cpp.parser.\n\n"
+           << "#[local] Open Scope bs_scope.\n\n"
+           << "Definition module : translation_unit :=\n"
+           << "  Eval " << reduction << " in decls (" << header->os.str()
+           << "nil) " << endian << ".\n";
+        os.flush();
+
+        auto name = module_name(header->file, text);
+        llvm::SmallString<256> path(dir_);
+        llvm::sys::path::append(path, name + ".v");
+        if (llvm::sys::fs::exists(path)) {
+            names.push_back(std::move(name));
+            continue;
+        }
+
+        // Other translation units may be writing the same file: write a
+        // temporary file and move it in place.
+        int fd;
+        llvm::SmallString<256> tmp;
+        if (auto ec = llvm::sys::fs::createUniqueFile(path + ".%%%%%%", fd,
+                                                       tmp)) {
+            report(path, ec);
+            continue;
+        }
+        {
+            llvm::raw_fd_ostream out(fd, true);
+            out << text;
+        }
+        if (auto ec = llvm::sys::fs::rename(tmp, path)) {
+            report(path, ec);
+            llvm::sys::fs::remove(tmp);
+            continue;
+        }
+        names.push_back(std::move(name));
+    }
+    return names;
+}
+
+// A header module that cannot be written is an error of the translation
+// unit, so that cpp2v fails rather than print a module that [Require]s it.
+void
+HeaderModules::report(llvm::StringRef path, std::error_code ec) {
+    auto& diags = sm_.getDiagnostics();
+    diags.Report(diags.getCustomDiagID(DiagnosticsEngine::Error,
+                                       "cannot write header module %0: %1"))
+        << path << ec.message();
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "InternedNames.hpp"
+#include "CoqPrinter.hpp"
+#include "llvm/Support/raw_ostream.h"
+
+static std::string
+ident(size_t k) {
+    return "n_" + std::to_string(k);
+}
+
+void
+InternedNames::print(llvm::StringRef name, const char* type, CoqPrinter& print,
+                     llvm::function_ref<std::string()> source) {
+    auto it = index_.find(name);
+    if (it == index_.end()) {
+        if (name.size() + 2 <= ident(names_.size()).size()) {
+            print.output() << "\"" << name << "\"";
+            return;
+        }
+        it = index_.try_emplace(name, names_.size()).first;
+        names_.push_back(Name{name.str(), type, source()});
+    }
+    print.output() << ident(it->second);
+}
+
+std::optional<llvm::StringRef>
+InternedNames::lookup(llvm::StringRef id) const {
+    size_t k;
+    if (not id.consume_front("n_") or id.getAsInteger(10, k) or
+        names_.size() <= k) {
+        return std::nullopt;
+    }
+    return llvm::StringRef(names_[k].name);
+}
+
+void
+InternedNames::print_definitions(CoqPrinter& print) const {
+    for (size_t k = 0; k < names_.size(); ++k) {
+        print.output() << "Definition " << ident(k) << " : " << names_[k].type
+                       << " := \"" << names_[k].name << "\"." << fmt::line;
+    }
+}
+
+void
+InternedNames::write_map(llvm::raw_ostream& os) const {
+    for (size_t k = 0; k < names_.size(); ++k) {
+        os << ident(k) << "\t" << names_[k].name << "\t" << names_[k].source
+           << "\n";
+    }
+}
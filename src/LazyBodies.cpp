@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "LazyBodies.hpp"
+#include "CoqPrinter.hpp"
+#include "llvm/Support/raw_ostream.h"
+
+void
+LazyBodies::print(CoqPrinter& print,
+                  llvm::function_ref<void(CoqPrinter&)> print_body) {
+    // Bodies may contain other bodies (of local classes and lambdas), which
+    // are defined before them.
+    std::string text;
+    llvm::raw_string_ostream os(text);
+    fmt::Formatter::State start;
+    start.depth = 1;
+    start.compact = print.output().state().compact;
+    {
+        fmt::Formatter out(os, start, 0);
+        CoqPrinter body_print(out, print.templates());
+        print_body(body_print);
+    }
+    os.flush();
+
+    print.output() << "body_" << bodies_.size();
+    bodies_.push_back(std::move(text));
+}
+
+void
+LazyBodies::print_definitions(CoqPrinter& print) const {
+    for (size_t k = 0; k < bodies_.size(); ++k) {
+        print.output() << "Definition body_" << k << " : Stmt :="
+                       << fmt::indent << fmt::line << bodies_[k] << "."
+                       << fmt::outdent << fmt::line;
+    }
+}
+
+void
+LazyBodies::print_names(CoqPrinter& print) const {
+    for (size_t k = 0; k < bodies_.size(); ++k) {
+        print.output() << fmt::nbsp << "body_" << k;
+    }
+}
@@ -8,11 +8,13 @@
 
 namespace logging {
 static Level log_level = Level::NONE;
+static thread_local llvm::raw_ostream* log_stream = nullptr;
 
 llvm::raw_ostream&
 log(Level level) {
+    // Fatal errors abort the whole process, so they are never redirected.
     if (level <= log_level) {
-        return llvm::errs();
+        return log_stream && level != FATAL ? *log_stream : llvm::errs();
     } else {
         return llvm::nulls();
     }
@@ -23,6 +25,11 @@ set_level(Level level) {
     log_level = level;
 }
 
+void
+set_stream(llvm::raw_ostream* out) {
+    log_stream = out;
+}
+
 [[noreturn]] void
 die() {
     llvm::outs().flush();
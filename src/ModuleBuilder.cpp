@@ -36,6 +36,9 @@ private:
     const bool templates_;
     SpecCollector &specs_;
     clang::ASTContext *const context_;
+    // Add the first declaration of an entity in an included file even if
+    // the entity is defined elsewhere (see [declare]).
+    const bool header_declarations_;
     std::set<int64_t> visited_;
 
 private:
@@ -59,12 +62,33 @@ private:
         }
     }
 
+    // Whether to add [decl], which is not the definition [defn], as a
+    // declaration. Only the first declaration of an entity without a
+    // definition is needed. With [--header-modules], the modules of headers
+    // must not depend on what the translation unit defines, so a first
+    // declaration in an included file is added regardless, and the entry of
+    // the definition replaces it when the modules are merged.
+    bool declare(const Decl *decl, const Decl *defn) const {
+        if (decl->getPreviousDecl() != nullptr) {
+            return false;
+        }
+        if (defn == nullptr) {
+            return true;
+        }
+        if (not header_declarations_) {
+            return false;
+        }
+        auto loc =
+            context_->getSourceManager().getPresumedLoc(decl->getLocation());
+        return loc.isValid() and loc.getIncludeLoc().isValid();
+    }
+
 public:
     BuildModule(::Module &m, Filter &filter, bool templates,
                 clang::ASTContext *context, SpecCollector &specs,
-                clang::CompilerInstance *ci)
+                clang::CompilerInstance *ci, bool header_declarations = false)
         : module_(m), filter_(filter), templates_(templates), specs_(specs),
-          context_(context) {}
+          context_(context), header_declarations_(header_declarations) {}
 
     void Visit(const Decl *d, Flags flags) {
         if (visited_.find(d->getID()) == visited_.end()) {
@@ -127,7 +151,7 @@ public:
         auto defn = decl->getDefinition();
         if (defn == decl) {
             go(decl, flags, true);
-        } else if (defn == nullptr && decl->getPreviousDecl() == nullptr) {
+        } else if (declare(decl, defn)) {
             go(decl, flags, false);
         }
     }
@@ -178,7 +202,7 @@ public:
                     }
                 }
             }
-        } else if (defn == nullptr && decl->getPreviousDecl() == nullptr) {
+        } else if (declare(decl, defn)) {
             go(decl, flags, false);
         }
     }
@@ -294,6 +318,47 @@ build_module(clang::TranslationUnitDecl *tu, ::Module &mod, Filter &filter,
         .VisitTranslationUnitDecl(tu, {});
 }
 
+ModuleBuilder::ModuleBuilder(::Module &mod, Filter &filter,
+                             SpecCollector &specs, clang::CompilerInstance *ci,
+                             bool templates, bool header_declarations)
+    : builder_(std::make_unique<BuildModule>(mod, filter, templates,
+                                             &ci->getASTContext(), specs, ci,
+                                             header_declarations)) {}
+
+ModuleBuilder::~ModuleBuilder() = default;
+
+// A function definition is final once its group has been parsed, unless it
+// is part of a template: specializations are still added at the end of the
+// translation unit, and are visited with their template. Records are not
+// final, as Sema declares their implicit members on demand.
+static bool
+is_final(const FunctionDecl *decl) {
+    return decl->doesThisDeclarationHaveABody() and
+           not decl->isDependentContext() and
+           decl->getTemplatedKind() == FunctionDecl::TK_NonTemplate;
+}
+
+void
+ModuleBuilder::add_final(const clang::Decl *decl) {
+    if (auto ns = dyn_cast<NamespaceDecl>(decl)) {
+        for (auto d : ns->decls()) {
+            add_final(d);
+        }
+    } else if (auto ls = dyn_cast<LinkageSpecDecl>(decl)) {
+        for (auto d : ls->decls()) {
+            add_final(d);
+        }
+    } else if (auto fd = dyn_cast<FunctionDecl>(decl); fd and is_final(fd)) {
+        // Marks [fd] as visited, so that [finish] skips it.
+        builder_->Visit(fd, {});
+    }
+}
+
+void
+ModuleBuilder::finish(const clang::TranslationUnitDecl *tu) {
+    builder_->VisitTranslationUnitDecl(tu, {});
+}
+
 void ::Module::add_assert(const clang::StaticAssertDecl *d) {
     asserts_.push_back(d);
 }
@@ -320,3 +385,11 @@ void ::Module::add_definition(const clang::NamedDecl *d, Flags flags) {
 void ::Module::add_declaration(const clang::NamedDecl *d, Flags flags) {
     add_decl(declarations_, template_declarations_, d, flags);
 }
+
+void ::Module::retain(
+    llvm::function_ref<bool(const clang::NamedDecl *)> keep,
+    llvm::function_ref<bool(const clang::StaticAssertDecl *)> keep_assert) {
+    declarations_.remove_if([&](auto d) { return not keep(d); });
+    definitions_.remove_if([&](auto d) { return not keep(d); });
+    asserts_.remove_if([&](auto d) { return not keep_assert(d); });
+}
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "OutputCache.hpp"
+#include "Logging.hpp"
+#include "Version.hpp"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstdio>
+#include <sys/file.h>
+#include <unistd.h>
+
+using namespace clang;
+namespace fs = llvm::sys::fs;
+namespace path = llvm::sys::path;
+
+// The file whose modification time records the last use of an entry.
+static const char STAMP[] = "stamp";
+
+std::string
+OutputCache::entry_path(llvm::StringRef key) const {
+    llvm::SmallString<256> result(dir_);
+    path::append(result, key.take_front(2), key.drop_front(2));
+    return std::string(result.str());
+}
+
+static void
+touch(const llvm::Twine& file) {
+    int fd;
+    if (not fs::openFileForWrite(file, fd)) {
+        ::close(fd);
+    }
+}
+
+bool
+OutputCache::restore(llvm::StringRef key, const Outputs& outputs) {
+    auto entry = entry_path(key);
+    bool hit = fs::is_directory(entry);
+    for (auto& [slot, out] : outputs) {
+        if (not hit) {
+            break;
+        }
+        if (out.has_value()) {
+            llvm::SmallString<256> file(entry);
+            path::append(file, slot);
+            hit = not fs::copy_file(file, *out);
+        }
+    }
+    if (hit) {
+        touch(entry + "/" + STAMP);
+    }
+    count(hit);
+    return hit;
+}
+
+void
+OutputCache::store(llvm::StringRef key, const Outputs& outputs) {
+    // Populate a fresh directory and move it into place, so that concurrent
+    // runs never see a partial entry.
+    llvm::SmallString<256> tmp;
+    if (fs::create_directories(dir_) or
+        fs::createUniqueDirectory(dir_ + "/tmp", tmp)) {
+        logging::log() << "cpp2v: cannot write to cache " << dir_ << "\n";
+        return;
+    }
+    for (auto& [slot, out] : outputs) {
+        if (out.has_value()) {
+            llvm::SmallString<256> file(tmp);
+            path::append(file, slot);
+            if (fs::copy_file(*out, file)) {
+                fs::remove_directories(tmp);
+                return;
+            }
+        }
+    }
+    touch(tmp + "/" + STAMP);
+
+    auto entry = entry_path(key);
+    if (fs::create_directories(path::parent_path(entry)) or
+        fs::rename(tmp, entry)) {
+        // Most likely, another run stored the same entry first.
+        fs::remove_directories(tmp);
+        return;
+    }
+    evict();
+}
+
+namespace {
+struct Entry {
+    std::string path;
+    llvm::sys::TimePoint<> used;
+    uint64_t size;
+};
+} // namespace
+
+static std::vector<Entry>
+list_entries(llvm::StringRef dir) {
+    std::vector<Entry> result;
+    std::error_code ec;
+    for (fs::directory_iterator i(dir, ec), end; not ec and i != end;
+         i.increment(ec)) {
+        auto prefix = path::filename(i->path());
+        if (prefix.size() != 2 or i->type() != fs::file_type::directory_file) {
+            continue;
+        }
+        for (fs::directory_iterator j(i->path(), ec); not ec and j != end;
+             j.increment(ec)) {
+            Entry entry{j->path(), {}, 0};
+            std::error_code fec;
+            for (fs::directory_iterator k(j->path(), fec); not fec and k != end;
+                 k.increment(fec)) {
+                fs::file_status st;
+                if (fs::status(k->path(), st)) {
+                    continue;
+                }
+                entry.size += st.getSize();
+                if (path::filename(k->path()) == STAMP) {
+                    entry.used = st.getLastModificationTime();
+                }
+            }
+            result.push_back(std::move(entry));
+        }
+    }
+    return result;
+}
+
+void
+OutputCache::evict() {
+    auto entries = list_entries(dir_);
+    uint64_t total = 0;
+    for (auto& e : entries) {
+        total += e.size;
+    }
+    if (total <= max_size_) {
+        return;
+    }
+
+    // Trim to 90% of the limit to avoid scanning on every store.
+    std::sort(entries.begin(), entries.end(),
+              [](auto& a, auto& b) { return a.used < b.used; });
+    for (auto& e : entries) {
+        if (total <= max_size_ / 10 * 9) {
+            break;
+        }
+        if (not fs::remove_directories(e.path)) {
+            total -= e.size;
+        }
+    }
+}
+
+// The statistics are two counters, stored in [dir_/stats] as
+// "<hits> <misses>" and updated under a file lock. We use [flock] rather
+// than [fs::lockFile] because the latter does not exclude other threads
+// (see the -j driver).
+void
+OutputCache::count(bool hit) {
+    if (fs::create_directories(dir_)) {
+        return;
+    }
+    llvm::SmallString<256> file(dir_);
+    path::append(file, "stats");
+    int fd;
+    if (fs::openFileForReadWrite(file, fd, fs::CD_OpenAlways, fs::OF_None)) {
+        return;
+    }
+    if (::flock(fd, LOCK_EX) == 0) {
+        char buf[64] = {};
+        unsigned long long hits = 0, misses = 0;
+        if (0 < ::pread(fd, buf, sizeof(buf) - 1, 0)) {
+            sscanf(buf, "%llu %llu", &hits, &misses);
+        }
+        (hit ? hits : misses)++;
+        auto len = snprintf(buf, sizeof(buf), "%llu %llu\n", hits, misses);
+        if (::pwrite(fd, buf, len, 0) == len) {
+            ::ftruncate(fd, len);
+        }
+        ::flock(fd, LOCK_UN);
+    }
+    ::close(fd);
+}
+
+void
+OutputCache::print_stats(llvm::raw_ostream& os) {
+    unsigned long long hits = 0, misses = 0;
+    llvm::SmallString<256> file(dir_);
+    path::append(file, "stats");
+    if (auto buf = llvm::MemoryBuffer::getFile(file)) {
+        sscanf((*buf)->getBufferStart(), "%llu %llu", &hits, &misses);
+    }
+    auto entries = list_entries(dir_);
+    uint64_t total = 0;
+    for (auto& e : entries) {
+        total += e.size;
+    }
+
+    os << "cache directory: " << dir_ << "\n"
+       << "hits:            " << hits << "\n"
+       << "misses:          " << misses << "\n"
+       << "entries:         " << entries.size() << "\n"
+       << "size:            " << total << " bytes (max " << max_size_
+       << ")\n";
+}
+
+namespace {
+// A stream that hashes everything written to it.
+class HashingStream : public llvm::raw_ostream {
+public:
+    explicit HashingStream(llvm::MD5& hash) : hash_(hash) {}
+
+    ~HashingStream() override {
+        flush();
+    }
+
+private:
+    void write_impl(const char* ptr, size_t size) override {
+        hash_.update(llvm::StringRef(ptr, size));
+        pos_ += size;
+    }
+
+    uint64_t current_pos() const override {
+        return pos_;
+    }
+
+    llvm::MD5& hash_;
+    uint64_t pos_{0};
+};
+
+// Hash the output of `clang -E -C`. Comments are included because cpp2v
+// reads specifications from them, and line markers because the output
+// depends on which file each declaration comes from (e.g. with [--filter],
+// [--roots] or [--lazy-elaboration]).
+class HashPreprocessedAction : public PreprocessorFrontendAction {
+public:
+    explicit HashPreprocessedAction(llvm::MD5& hash) : hash_(hash) {}
+
+protected:
+    void ExecuteAction() override {
+        auto& CI = getCompilerInstance();
+        auto& opts = CI.getPreprocessorOutputOpts();
+        opts.ShowCPP = 1;
+        opts.ShowComments = 1;
+        opts.ShowMacroComments = 1;
+        opts.ShowLineMarkers = 1;
+        HashingStream os(hash_);
+        DoPrintPreprocessedInput(CI.getPreprocessor(), &os, opts);
+    }
+
+private:
+    llvm::MD5& hash_;
+};
+
+class HashPreprocessedActionFactory : public tooling::FrontendActionFactory {
+public:
+    explicit HashPreprocessedActionFactory(llvm::MD5& hash) : hash_(hash) {}
+
+    std::unique_ptr<FrontendAction> create() override {
+        return std::make_unique<HashPreprocessedAction>(hash_);
+    }
+
+private:
+    llvm::MD5& hash_;
+};
+
+void
+update_field(llvm::MD5& hash, llvm::StringRef field) {
+    hash.update(field);
+    hash.update(llvm::StringRef("\0", 1));
+}
+} // namespace
+
+// [ClangTool] moves to the directory of each compile command. The real file
+// system does so for the whole process, under the feet of the other threads
+// of [run_parallel], so a tool with a [FileManager] of its own gets a
+// physical file system, which keeps a directory of its own. [files] (in a
+// server job, which is alone in its process) reads through the real one.
+llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>
+job_file_system(FileManager* files) {
+    if (files) {
+        return llvm::vfs::getRealFileSystem();
+    }
+    return llvm::vfs::createPhysicalFileSystem();
+}
+
+std::optional<std::string>
+cache_key(const tooling::CompilationDatabase& db, const std::string& source,
+          llvm::StringRef mode, FileManager* files) {
+    llvm::MD5 hash;
+    update_field(hash, cpp2v::VERSION);
+    update_field(hash, cpp2v::build_id());
+    update_field(hash, mode);
+    for (auto& cmd : db.getCompileCommands(source)) {
+        for (auto& arg : cmd.CommandLine) {
+            update_field(hash, arg);
+        }
+    }
+
+    tooling::ClangTool tool(db, {source},
+                            std::make_shared<PCHContainerOperations>(),
+                            job_file_system(files), files);
+    tool.setRestoreWorkingDir(false);
+    IgnoringDiagConsumer diags;
+    tool.setDiagnosticConsumer(&diags);
+    HashPreprocessedActionFactory factory(hash);
+    if (tool.run(&factory) != 0) {
+        return std::nullopt;
+    }
+
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    return std::string(result.digest().str());
+}
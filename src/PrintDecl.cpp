@@ -140,7 +140,7 @@ printFunction(const FunctionDecl *decl, CoqPrinter &print,
     if (decl->getBody()) {
         print.ctor("Some", false);
         print.ctor("Impl", false);
-        cprint.printStmt(decl->getBody(), print);
+        cprint.printBody(decl->getBody(), print);
         print.end_ctor();
         print.end_ctor();
     } else if (auto builtin = builtin_id(decl)) {
@@ -178,7 +178,7 @@ printMethod(const CXXMethodDecl *decl, CoqPrinter &print,
     if (decl->getBody()) {
         print.ctor("Some", false);
         print.ctor("UserDefined");
-        cprint.printStmt(decl->getBody(), print);
+        cprint.printBody(decl->getBody(), print);
         print.end_ctor();
         print.end_ctor();
     } else if (decl->isDefaulted()) {
@@ -204,7 +204,7 @@ printDestructor(const CXXDestructorDecl *decl, CoqPrinter &print,
     if (decl->getBody()) {
         print.some();
         print.ctor("UserDefined");
-        cprint.printStmt(decl->getBody(), print);
+        cprint.printBody(decl->getBody(), print);
 
         print.end_ctor();
         print.end_ctor();
@@ -722,7 +722,7 @@ public:
             }
             print.end_list();
             print.next_tuple();
-            cprint.printStmt(decl->getBody(), print);
+            cprint.printBody(decl->getBody(), print);
             print.end_tuple();
             print.end_ctor();
             print.end_ctor();
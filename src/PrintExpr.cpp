@@ -15,7 +15,10 @@
 #include "clang/Basic/Builtins.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/Version.inc"
+#include "llvm/ADT/FoldingSet.h"
 #include <bit>
+#include <list>
+#include <vector>
 
 using namespace clang;
 using namespace fmt;
@@ -63,6 +66,22 @@ is_builtin(const Decl* d) {
     return false;
 }
 
+// The builtin function that [expr] refers to, which is printed as a
+// variable of the type of [expr].
+//
+// todo(gmm): this is a complete hack because there is no way that i know of
+// to get the type of a builtin. what this does is get the type of the expression
+// that contains the builtin.
+static const DeclRefExpr*
+builtin_ref(const ImplicitCastExpr* expr) {
+    if (auto ref = dyn_cast<DeclRefExpr>(expr->getSubExpr())) {
+        if (is_builtin(ref->getDecl())) {
+            return ref;
+        }
+    }
+    return nullptr;
+}
+
 void
 printCast(const CastExpr* ce, CoqPrinter& print, ClangPrinter& cprint) {
     switch (ce->getCastKind()) {
@@ -182,6 +201,254 @@ private:
 public:
     static PrintExpr printer;
 
+    // Long chains of expressions, such as [a + b + c + ...],
+    // [os << a << b << ...] or [c1 ? a : c2 ? b : ...], nest an operand of
+    // each expression in the next. [open] prints an expression up to that
+    // operand and returns it, with the names to print it with in [names],
+    // and [close] prints the rest of the expression, so that [print_expr]
+    // goes down such chains in a loop rather than by recursion. For other
+    // expressions, [open] prints nothing and returns null.
+    const Expr* open(const Expr* expr, CoqPrinter& print, ClangPrinter& cprint,
+                     const ASTContext& ctxt, OpaqueNames*& names,
+                     std::list<OpaqueNames>& fresh) {
+        auto& li = *names;
+        if (auto paren = dyn_cast<ParenExpr>(expr)) {
+            return paren->getSubExpr();
+        }
+#if CLANG_VERSION_MAJOR >= 8
+        if (auto constant = dyn_cast<ConstantExpr>(expr)) {
+            return constant->getSubExpr();
+        }
+#endif
+        if (auto bin = dyn_cast<BinaryOperator>(expr)) {
+#define ACASE(k, v)                                                            \
+    case BinaryOperatorKind::BO_##k##Assign:                                   \
+        print.ctor("Eassign_op") << #v << fmt::nbsp;                           \
+        break;
+
+            switch (bin->getOpcode()) {
+            // The operands of these are printed without the names of [li].
+            case BinaryOperatorKind::BO_Comma:
+                print.ctor("Ecomma");
+                names = &fresh.emplace_back();
+                break;
+            case BinaryOperatorKind::BO_LAnd:
+                print.ctor("Eseqand");
+                names = &fresh.emplace_back();
+                break;
+            case BinaryOperatorKind::BO_LOr:
+                print.ctor("Eseqor");
+                names = &fresh.emplace_back();
+                break;
+            case BinaryOperatorKind::BO_Assign:
+                print.ctor("Eassign");
+                break;
+                ACASE(Add, Badd)
+                ACASE(And, Band)
+                ACASE(Div, Bdiv)
+                ACASE(Mul, Bmul)
+                ACASE(Or, Bor)
+                ACASE(Rem, Bmod)
+                ACASE(Shl, Bshl)
+                ACASE(Shr, Bshr)
+                ACASE(Sub, Bsub)
+                ACASE(Xor, Bxor)
+            default:
+                print.ctor("Ebinop");
+                printBinaryOperator(bin, print, cprint, ctxt);
+                print.output() << fmt::nbsp;
+                break;
+            }
+#undef ACASE
+            return bin->getLHS();
+        }
+        if (auto cond = dyn_cast<ConditionalOperator>(expr)) {
+            print.ctor("Eif");
+            cprint.printExpr(cond->getCond(), print, li);
+            print.output() << fmt::nbsp;
+            cprint.printExpr(cond->getTrueExpr(), print, li);
+            print.output() << fmt::nbsp;
+            return cond->getFalseExpr();
+        }
+        if (auto cast = dyn_cast<CastExpr>(expr)) {
+            if ((isa<CXXNamedCastExpr>(cast) and
+                 not cast->getConversionFunction()) or
+                cast->getCastKind() == CastKind::CK_ConstructorConversion) {
+                return nullptr;
+            }
+            if (auto implicit = dyn_cast<ImplicitCastExpr>(cast)) {
+                if (builtin_ref(implicit)) {
+                    return nullptr;
+                }
+            }
+            print.ctor("Ecast");
+            if (auto cf = cast->getConversionFunction()) {
+                // desugar user casts to function calls
+                auto vd = dyn_cast<ValueDecl>(cf);
+                assert(vd && "conversion function must be a [ValueDecl]");
+                print.ctor("Cuser");
+                cprint.printObjName(vd, print);
+                print.end_ctor();
+            } else {
+                printCast(cast, print, cprint);
+            }
+            print.output() << fmt::nbsp;
+            return cast->getSubExpr();
+        }
+        if (auto call = dyn_cast<CXXOperatorCallExpr>(expr)) {
+            // TODO operator calls sometimes have stricter order of evaluation
+            // than regular function calls. Because our semantics overapproximates
+            // the possible behaviors, it is sound for us to directly desugar them.
+            auto callee = call->getCalleeDecl();
+            auto method = dyn_cast<CXXMethodDecl>(callee);
+            // some operator calls are actually method calls.
+            // because we (and C++) distinguish between member calls
+            // and function calls, we need to desugar this to a method
+            // if the called function is a method.
+            if (method and not method->isStatic()) {
+                print.ctor("Emember_call");
+
+                // TODO Handle virtual dispatch.
+                print.ctor("inl") << fmt::lparen;
+                cprint.printObjName(method, print);
+                print.output() << "," << fmt::nbsp
+                               << (method->isVirtual() ? "Virtual" : "Direct")
+                               << "," << fmt::nbsp;
+                cprint.printQualType(method->getType(), print);
+                print.output() << fmt::rparen;
+                print.end_ctor() << fmt::nbsp;
+                return call->getArg(0);
+            } else if (not isa<FunctionDecl>(callee)) {
+                return nullptr;
+            }
+        }
+        // Not member calls, which have a visitor of their own.
+        if (auto call = dyn_cast<CallExpr>(expr)) {
+            if (not isa<CXXMemberCallExpr>(call) and call->getNumArgs() != 0) {
+                if (print.templates() && is_dependent(call)) {
+                    /*
+                    Either the function or an argument is dependent.
+                    */
+                    print.ctor("Eunresolved_call");
+                } else {
+                    print.ctor("Ecall");
+                }
+                cprint.printExpr(call->getCallee(), print, li);
+                print.output() << fmt::line;
+                print.begin_list();
+                return call->getArg(0);
+            }
+        }
+        return nullptr;
+    }
+
+    // Print the rest of [expr], which [open] printed the start of, with the
+    // names [li].
+    void close(const Expr* expr, CoqPrinter& print, ClangPrinter& cprint,
+               OpaqueNames& li) {
+        if (auto bin = dyn_cast<BinaryOperator>(expr)) {
+            print.output() << fmt::nbsp;
+            switch (bin->getOpcode()) {
+            case BinaryOperatorKind::BO_Comma:
+                cprint.printExpr(bin->getRHS(), print);
+                // TODO: Can be overloaded
+                assert(bin->getRHS()->getType() == bin->getType() &&
+                       "types must match");
+                print.end_ctor(); // no type information
+                return;
+            case BinaryOperatorKind::BO_LAnd:
+                cprint.printExpr(bin->getRHS(), print);
+                // TODO: Can be overloaded
+                assert(bin->getType().getTypePtr()->isBooleanType() &&
+                       "&& is a bool");
+                print.end_ctor(); // no type information
+                return;
+            case BinaryOperatorKind::BO_LOr:
+                cprint.printExpr(bin->getRHS(), print);
+                // TODO: Can be overloaded
+                assert(bin->getType().getTypePtr()->isBooleanType() &&
+                       "|| is a bool");
+                print.end_ctor(); // no type information
+                return;
+            default:
+                cprint.printExpr(bin->getRHS(), print, li);
+                done(bin, print, cprint,
+                     print.templates() ? Done::O : Done::T);
+                return;
+            }
+        }
+        if (isa<ConditionalOperator>(expr) or isa<CastExpr>(expr)) {
+            done(expr, print, cprint, Done::VT);
+            return;
+        }
+        if (auto call = dyn_cast<CXXOperatorCallExpr>(expr)) {
+            auto method = dyn_cast<CXXMethodDecl>(call->getCalleeDecl());
+            if (method and not method->isStatic()) {
+                print.output() << fmt::nbsp;
+                // note skip the first parameter because it is the object.
+                print.list_range(++call->arg_begin(), call->arg_end(),
+                                 [&](auto print, auto i) {
+                                     cprint.printExpr(i, print, li);
+                                 });
+                done(call, print, cprint);
+                return;
+            }
+        }
+        if (auto call = dyn_cast<CallExpr>(expr)) {
+            print.cons();
+            for (auto i = ++call->arg_begin(); i != call->arg_end(); ++i) {
+                cprint.printExpr(*i, print, li);
+                print.cons();
+            }
+            print.end_list();
+            if (print.templates() && is_dependent(call)) {
+                print.end_ctor();
+            } else {
+                done(call, print, cprint);
+            }
+        }
+        // Nothing to close for parentheses and constants.
+    }
+
+    // Print [expr] with the names [li].
+    void print_expr(const Expr* expr, CoqPrinter& print, ClangPrinter& cprint,
+                    const ASTContext& ctxt, OpaqueNames& li) {
+        struct Open {
+            const Expr* expr;
+            OpaqueNames* names;
+        };
+        llvm::SmallVector<Open, 16> stack;
+        std::list<OpaqueNames> fresh;
+        auto names = &li;
+        for (;;) {
+            auto inner = names;
+            auto operand = open(expr, print, cprint, ctxt, inner, fresh);
+            if (operand == nullptr) {
+                break;
+            }
+            stack.push_back(Open{expr, names});
+            expr = operand;
+            names = inner;
+        }
+        Visit(expr, print, cprint, ctxt, *names);
+        while (not stack.empty()) {
+            auto top = stack.pop_back_val();
+            close(top.expr, print, cprint, *top.names);
+        }
+    }
+
+    // Print [expr], which [open] goes down into, when a visitor gets to it
+    // rather than [print_expr].
+    void visit_open(const Expr* expr, CoqPrinter& print, ClangPrinter& cprint,
+                    const ASTContext& ctxt, OpaqueNames& li) {
+        std::list<OpaqueNames> fresh;
+        auto names = &li;
+        auto operand = open(expr, print, cprint, ctxt, names, fresh);
+        assert(operand && "[open] goes down into the expression");
+        cprint.printExpr(operand, print, *names);
+        close(expr, print, cprint, li);
+    }
+
     void VisitStmt(const Stmt* stmt, CoqPrinter& print, ClangPrinter& cprint,
                    const ASTContext&, OpaqueNames&) {
         logging::fatal() << "Error: while printing an expr, got a statement '"
@@ -267,66 +534,7 @@ public:
     void VisitBinaryOperator(const BinaryOperator* expr, CoqPrinter& print,
                              ClangPrinter& cprint, const ASTContext& ctxt,
                              OpaqueNames& li) {
-#define ACASE(k, v)                                                            \
-    case BinaryOperatorKind::BO_##k##Assign:                                   \
-        print.ctor("Eassign_op") << #v << fmt::nbsp;                           \
-        break;
-
-        switch (expr->getOpcode()) {
-        case BinaryOperatorKind::BO_Comma:
-            print.ctor("Ecomma");
-            cprint.printExpr(expr->getLHS(), print);
-            print.output() << fmt::nbsp;
-            cprint.printExpr(expr->getRHS(), print);
-            // TODO: Can be overloaded
-            assert(expr->getRHS()->getType() == expr->getType() &&
-                   "types must match");
-            print.end_ctor(); // no type information
-            return;
-        case BinaryOperatorKind::BO_LAnd:
-            print.ctor("Eseqand");
-            cprint.printExpr(expr->getLHS(), print);
-            print.output() << fmt::nbsp;
-            cprint.printExpr(expr->getRHS(), print);
-            // TODO: Can be overloaded
-            assert(expr->getType().getTypePtr()->isBooleanType() &&
-                   "&& is a bool");
-            print.end_ctor(); // no type information
-            return;
-        case BinaryOperatorKind::BO_LOr:
-            print.ctor("Eseqor");
-            cprint.printExpr(expr->getLHS(), print);
-            print.output() << fmt::nbsp;
-            cprint.printExpr(expr->getRHS(), print);
-            // TODO: Can be overloaded
-            assert(expr->getType().getTypePtr()->isBooleanType() &&
-                   "|| is a bool");
-            print.end_ctor(); // no type information
-            return;
-        case BinaryOperatorKind::BO_Assign:
-            print.ctor("Eassign");
-            break;
-            ACASE(Add, Badd)
-            ACASE(And, Band)
-            ACASE(Div, Bdiv)
-            ACASE(Mul, Bmul)
-            ACASE(Or, Bor)
-            ACASE(Rem, Bmod)
-            ACASE(Shl, Bshl)
-            ACASE(Shr, Bshr)
-            ACASE(Sub, Bsub)
-            ACASE(Xor, Bxor)
-        default:
-            print.ctor("Ebinop");
-            printBinaryOperator(expr, print, cprint, ctxt);
-            print.output() << fmt::nbsp;
-            break;
-        }
-#undef ACASE
-        cprint.printExpr(expr->getLHS(), print, li);
-        print.output() << fmt::nbsp;
-        cprint.printExpr(expr->getRHS(), print, li);
-        done(expr, print, cprint, print.templates() ? Done::O : Done::T);
+        visit_open(expr, print, cprint, ctxt, li);
     }
 
     void VisitDependentScopeDeclRefExpr(const DependentScopeDeclRefExpr* expr,
@@ -470,114 +678,64 @@ public:
     }
 
     void VisitCallExpr(const CallExpr* expr, CoqPrinter& print,
-                       ClangPrinter& cprint, const ASTContext&,
+                       ClangPrinter& cprint, const ASTContext& ctxt,
                        OpaqueNames& li) {
+        if (expr->getNumArgs() != 0) {
+            visit_open(expr, print, cprint, ctxt, li);
+            return;
+        }
         if (print.templates() && is_dependent(expr)) {
             /*
             Either the function or an argument is dependent.
             */
             print.ctor("Eunresolved_call");
             cprint.printExpr(expr->getCallee(), print, li);
-            print.output() << fmt::line;
-            print.list(expr->arguments(), [&](auto print, auto i) {
-                cprint.printExpr(i, print, li);
-            });
+            print.output() << fmt::line << "nil";
             print.end_ctor();
             return;
         }
 
         print.ctor("Ecall");
         cprint.printExpr(expr->getCallee(), print, li);
-        print.output() << fmt::line;
-        print.list(expr->arguments(),
-                   [&](auto print, auto i) { cprint.printExpr(i, print, li); });
+        print.output() << fmt::line << "nil";
         done(expr, print, cprint);
     }
 
     void VisitCXXOperatorCallExpr(const CXXOperatorCallExpr* expr,
                                   CoqPrinter& print, ClangPrinter& cprint,
                                   const ASTContext& ctxt, OpaqueNames& li) {
-        // TODO operator calls sometimes have stricter order of evaluation
-        // than regular function calls. Because our semantics overapproximates
-        // the possible behaviors, it is sound for us to directly desugar them.
         auto callee = expr->getCalleeDecl();
         auto method = dyn_cast<CXXMethodDecl>(callee);
-        // some operator calls are actually method calls.
-        // because we (and C++) distinguish between member calls
-        // and function calls, we need to desugar this to a method
-        // if the called function is a method.
         if (method and not method->isStatic()) {
-            print.ctor("Emember_call");
-
-            // TODO Handle virtual dispatch.
-            print.ctor("inl") << fmt::lparen;
-            cprint.printObjName(method, print);
-            print.output() << "," << fmt::nbsp
-                           << (method->isVirtual() ? "Virtual" : "Direct")
-                           << "," << fmt::nbsp;
-            cprint.printQualType(method->getType(), print);
-            print.output() << fmt::rparen;
-            print.end_ctor() << fmt::nbsp;
-
-            cprint.printExpr(expr->getArg(0), print, li);
-
-            print.output() << fmt::nbsp;
-            // note skip the first parameter because it is the object.
-            print.list_range(
-                ++expr->arg_begin(), expr->arg_end(),
-                [&](auto print, auto i) { cprint.printExpr(i, print, li); });
-
-            done(expr, print, cprint);
+            visit_open(expr, print, cprint, ctxt, li);
         } else if (isa<FunctionDecl>(callee)) {
             VisitCallExpr(expr, print, cprint, ctxt, li);
         }
     }
 
     void VisitCastExpr(const CastExpr* expr, CoqPrinter& print,
-                       ClangPrinter& cprint, const ASTContext&,
+                       ClangPrinter& cprint, const ASTContext& ctxt,
                        OpaqueNames& li) {
         if (expr->getCastKind() == CastKind::CK_ConstructorConversion) {
             // note: the Clang AST records a "FunctionalCastExpr" with a constructor
             // but the child node of this is the constructor!
             cprint.printExpr(expr->getSubExpr(), print);
-        } else if (auto cf = expr->getConversionFunction()) {
-            // desugar user casts to function calls
-            auto vd = dyn_cast<ValueDecl>(cf);
-            assert(vd && "conversion function must be a [ValueDecl]");
-            print.ctor("Ecast");
-            print.ctor("Cuser");
-            cprint.printObjName(vd, print);
-            print.end_ctor();
-
-            print.output() << fmt::nbsp;
-            cprint.printExpr(expr->getSubExpr(), print, li);
-            done(expr, print, cprint, Done::VT);
         } else {
-            print.ctor("Ecast");
-            printCast(expr, print, cprint);
-
-            print.output() << fmt::nbsp;
-            cprint.printExpr(expr->getSubExpr(), print, li);
-            done(expr, print, cprint, Done::VT);
+            visit_open(expr, print, cprint, ctxt, li);
         }
     }
 
     void VisitImplicitCastExpr(const ImplicitCastExpr* expr, CoqPrinter& print,
                                ClangPrinter& cprint, const ASTContext& ctxt,
                                OpaqueNames& li) {
-        // todo(gmm): this is a complete hack because there is no way that i know of
-        // to get the type of a builtin. what this does is get the type of the expression
-        // that contains the builtin.
-        if (auto ref = dyn_cast<DeclRefExpr>(expr->getSubExpr())) {
-            if (is_builtin(ref->getDecl())) {
-                // assume that this is a builtin
-                print.ctor("Evar", false);
-                print.ctor("Gname", false);
-                cprint.printObjName(ref->getDecl(), print);
-                print.end_ctor();
-                done(expr, print, cprint);
-                return;
-            }
+        if (auto ref = builtin_ref(expr)) {
+            // assume that this is a builtin
+            print.ctor("Evar", false);
+            print.ctor("Gname", false);
+            cprint.printObjName(ref->getDecl(), print);
+            print.end_ctor();
+            done(expr, print, cprint);
+            return;
         }
         VisitCastExpr(expr, print, cprint, ctxt, li);
     }
@@ -662,6 +820,17 @@ public:
         // internal character representation of BRiCk.
         auto bytes = lit->getBytes();
         const unsigned width = lit->getCharByteWidth();
+        // Narrow string literals are printed as a bytestring (see
+        // [CoqPrinter::escaped_str]), which is much smaller than a list of
+        // numbers.
+        if (width == 1 and not print.templates()) {
+            print.ctor("string_to_bytes", false);
+            print.escaped_str(lit);
+            print.end_ctor();
+            print_string_type(lit, print, cprint);
+            print.end_ctor();
+            return;
+        }
         print.begin_list();
         for (unsigned i = 0, len = lit->getByteLength(); i < len;) {
             unsigned long long byte = 0;
@@ -938,14 +1107,8 @@ public:
 
     void VisitConditionalOperator(const ConditionalOperator* expr,
                                   CoqPrinter& print, ClangPrinter& cprint,
-                                  const ASTContext&, OpaqueNames& li) {
-        print.ctor("Eif");
-        cprint.printExpr(expr->getCond(), print, li);
-        print.output() << fmt::nbsp;
-        cprint.printExpr(expr->getTrueExpr(), print, li);
-        print.output() << fmt::nbsp;
-        cprint.printExpr(expr->getFalseExpr(), print, li);
-        done(expr, print, cprint, Done::VT);
+                                  const ASTContext& ctxt, OpaqueNames& li) {
+        visit_open(expr, print, cprint, ctxt, li);
     }
 
     void VisitBinaryConditionalOperator(const BinaryConditionalOperator* expr,
@@ -1010,8 +1173,72 @@ public:
         print.end_ctor();
     }
 
+    // Whether [a] and [b], which have the same [Expr::Profile], print the
+    // same. The profile covers the structure, the values of literals and the
+    // declarations referred to, but not the types of most nodes, e.g. of the
+    // implicit casts and value initializations of the [0]s in
+    // [struct { long a; char b; } s = {0, 0}]. This compares those, walking
+    // down both in step.
+    static bool same_init(const Stmt* a, const Stmt* b) {
+        if (a == nullptr or b == nullptr) {
+            return a == b;
+        }
+        if (a->getStmtClass() != b->getStmtClass()) {
+            return false;
+        }
+        // Opaque values are printed by their number in [OpaqueNames].
+        if (isa<OpaqueValueExpr>(a)) {
+            return a == b;
+        }
+        if (auto ea = dyn_cast<Expr>(a)) {
+            auto eb = cast<Expr>(b);
+            if (ea->getType() != eb->getType() or
+                ea->getValueKind() != eb->getValueKind()) {
+                return false;
+            }
+        }
+        if (auto ca = dyn_cast<CastExpr>(a)) {
+            if (ca->getCastKind() != cast<CastExpr>(b)->getCastKind()) {
+                return false;
+            }
+        }
+        auto ia = a->child_begin(), ib = b->child_begin();
+        for (; ia != a->child_end() and ib != b->child_end(); ++ia, ++ib) {
+            if (not same_init(*ia, *ib)) {
+                return false;
+            }
+        }
+        return ia == a->child_end() and ib == b->child_end();
+    }
+
+    // The runs of equal elements of [inits] (see [same_init]), as the index
+    // of their first element and their length, if there are runs long enough
+    // to be worth printing as such.
+    static std::vector<std::pair<unsigned, unsigned>>
+    init_runs(ArrayRef<const Expr*> inits, const ASTContext& ctxt) {
+        const unsigned min_run = 4;
+        std::vector<std::pair<unsigned, unsigned>> runs;
+        llvm::FoldingSetNodeID last;
+        bool worth = false;
+        for (unsigned i = 0; i < inits.size(); ++i) {
+            llvm::FoldingSetNodeID id;
+            inits[i]->Profile(id, ctxt, true);
+            if (i != 0 and id == last and
+                same_init(inits[runs.back().first], inits[i])) {
+                worth |= ++runs.back().second >= min_run;
+                continue;
+            }
+            runs.emplace_back(i, 1);
+            last = std::move(id);
+        }
+        if (not worth) {
+            runs.clear();
+        }
+        return runs;
+    }
+
     void VisitInitListExpr(const InitListExpr* expr, CoqPrinter& print,
-                           ClangPrinter& cprint, const ASTContext&,
+                           ClangPrinter& cprint, const ASTContext& ctxt,
                            OpaqueNames& li) {
         if (expr->isTransparent()) {
             // "transparent" intializer lists are no-ops in the semantics
@@ -1019,11 +1246,28 @@ public:
             assert(expr->inits().size() == 1);
             cprint.printExpr(expr->getInit(0), print, li);
         } else {
-            print.ctor("Einitlist");
-
-            print.list(expr->inits(), [&](auto print, auto i) {
-                cprint.printExpr(i, print, li);
-            }) << fmt::nbsp;
+            ArrayRef<const Expr*> inits(expr->getInits(), expr->getNumInits());
+            auto runs = print.templates()
+                            ? std::vector<std::pair<unsigned, unsigned>>{}
+                            : init_runs(inits, ctxt);
+            if (runs.empty()) {
+                print.ctor("Einitlist");
+                print.list(expr->inits(), [&](auto print, auto i) {
+                    cprint.printExpr(i, print, li);
+                }) << fmt::nbsp;
+            } else {
+                // Lookup tables and zero-filled buffers are printed with
+                // each run of equal elements once, e.g.
+                // [(Einitlist_runs ((init_run 1000 (Eint 0 Tint)) :: nil) ..)].
+                auto print_run = [&](auto print, auto run) {
+                    print.ctor("init_run", false) << run.second << fmt::nbsp;
+                    cprint.printExpr(inits[run.first], print, li);
+                    print.end_ctor();
+                };
+                print.ctor("Einitlist_runs");
+                print.list_range(runs.begin(), runs.end(), print_run)
+                    << fmt::nbsp;
+            }
 
             if (expr->getArrayFiller()) {
                 print.some();
@@ -1406,7 +1650,7 @@ void
 ClangPrinter::printExpr(const clang::Expr* expr, CoqPrinter& print,
                         OpaqueNames& li) {
     auto depth = print.output().get_depth();
-    PrintExpr::printer.Visit(expr, print, *this, *this->context_, li);
+    PrintExpr::printer.print_expr(expr, print, *this, *this->context_, li);
     if (depth != print.output().get_depth()) {
         using namespace logging;
         fatal() << "Error: BUG indentation bug in during: "
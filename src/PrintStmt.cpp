@@ -6,6 +6,7 @@
 #include "ClangPrinter.hpp"
 #include "CoqPrinter.hpp"
 #include "Formatter.hpp"
+#include "LazyBodies.hpp"
 #include "Logging.hpp"
 #include "clang/AST/Mangle.h"
 #include "clang/AST/StmtVisitor.h"
@@ -26,6 +27,69 @@ private:
 public:
     static PrintStmt printer;
 
+    // Chains of statements, such as [if ... else if ... else ...], the
+    // labels of a switch ([case 1: case 2: ...], which nest each label in
+    // the previous one) or labels, nest a statement in the last position of
+    // the next. [open] prints a statement up to that sub-statement and
+    // returns it, and [close] prints the rest, so that [print_stmt] goes
+    // down such chains in a loop rather than by recursion. For other
+    // statements, [open] prints nothing and returns null.
+    const Stmt *open(const Stmt *stmt, CoqPrinter &print, ClangPrinter &cprint,
+                     ASTContext &ctxt) {
+        if (auto s = dyn_cast<IfStmt>(stmt)) {
+            if (s->getElse()) {
+                print_if(s, print, cprint);
+                return s->getElse();
+            }
+        } else if (auto s = dyn_cast<CaseStmt>(stmt)) {
+            print_case(s, print, ctxt);
+            return s->getSubStmt();
+        } else if (auto s = dyn_cast<DefaultStmt>(stmt)) {
+            if (s->getSubStmt()) {
+                print.output() << "Sdefault";
+                print.cons();
+                return s->getSubStmt();
+            }
+        } else if (auto s = dyn_cast<LabelStmt>(stmt)) {
+            print.ctor("Slabeled");
+            print.str(s->getDecl()->getNameAsString()) << fmt::nbsp;
+            return s->getSubStmt();
+        }
+        return nullptr;
+    }
+
+    // Print the rest of [stmt], which [open] printed the start of.
+    void close(const Stmt *stmt, CoqPrinter &print) {
+        if (isa<IfStmt>(stmt) or isa<LabelStmt>(stmt)) {
+            print.end_ctor();
+        }
+        // Nothing to close for [case] and [default], whose sub-statements
+        // come last in the list of the switch.
+    }
+
+    void print_stmt(const Stmt *stmt, CoqPrinter &print, ClangPrinter &cprint,
+                    ASTContext &ctxt) {
+        llvm::SmallVector<const Stmt *, 16> stack;
+        while (auto sub = open(stmt, print, cprint, ctxt)) {
+            stack.push_back(stmt);
+            stmt = sub;
+        }
+        Visit(stmt, print, cprint, ctxt);
+        while (not stack.empty()) {
+            close(stack.pop_back_val(), print);
+        }
+    }
+
+    // Print [stmt], which [open] goes down into, when a visitor gets to it
+    // rather than [print_stmt].
+    void visit_open(const Stmt *stmt, CoqPrinter &print, ClangPrinter &cprint,
+                    ASTContext &ctxt) {
+        auto sub = open(stmt, print, cprint, ctxt);
+        assert(sub && "[open] goes down into the statement");
+        cprint.printStmt(sub, print);
+        close(stmt, print);
+    }
+
     void VisitStmt(const Stmt *stmt, CoqPrinter &print, ClangPrinter &cprint,
                    ASTContext &ctxt) {
         using namespace logging;
@@ -155,7 +219,19 @@ public:
     }
 
     void VisitIfStmt(const IfStmt *stmt, CoqPrinter &print,
-                     ClangPrinter &cprint, ASTContext &) {
+                     ClangPrinter &cprint, ASTContext &ctxt) {
+        if (stmt->getElse()) {
+            visit_open(stmt, print, cprint, ctxt);
+            return;
+        }
+        print_if(stmt, print, cprint);
+        print.output() << "Sskip";
+        print.end_ctor();
+    }
+
+    // Print [stmt] up to its [else] branch.
+    void print_if(const IfStmt *stmt, CoqPrinter &print,
+                  ClangPrinter &cprint) {
         print.ctor("Sif");
         if (auto v = stmt->getConditionVariable()) {
             print.some();
@@ -169,16 +245,16 @@ public:
         print.output() << fmt::nbsp;
         cprint.printStmt(stmt->getThen(), print);
         print.output() << fmt::nbsp;
-        if (stmt->getElse()) {
-            cprint.printStmt(stmt->getElse(), print);
-        } else {
-            print.output() << "Sskip";
-        }
-        print.end_ctor();
     }
 
     void VisitCaseStmt(const CaseStmt *stmt, CoqPrinter &print,
                        ClangPrinter &cprint, ASTContext &ctxt) {
+        visit_open(stmt, print, cprint, ctxt);
+    }
+
+    // Print the label of [stmt], up to its sub-statement.
+    void print_case(const CaseStmt *stmt, CoqPrinter &print,
+                    ASTContext &ctxt) {
         // note, this only occurs when printing the body of a switch statement
         print.ctor("Scase");
 
@@ -197,17 +273,14 @@ public:
         print.end_ctor();
 
         print.cons();
-
-        cprint.printStmt(stmt->getSubStmt(), print);
     }
 
     void VisitDefaultStmt(const DefaultStmt *stmt, CoqPrinter &print,
-                          ClangPrinter &cprint, ASTContext &) {
-        print.output() << "Sdefault";
-
+                          ClangPrinter &cprint, ASTContext &ctxt) {
         if (stmt->getSubStmt()) {
-            print.cons();
-            cprint.printStmt(stmt->getSubStmt(), print);
+            visit_open(stmt, print, cprint, ctxt);
+        } else {
+            print.output() << "Sdefault";
         }
     }
 
@@ -323,11 +396,8 @@ public:
     }
 
     void VisitLabelStmt(const LabelStmt *stmt, CoqPrinter &print,
-                        ClangPrinter &cprint, ASTContext &) {
-        print.ctor("Slabeled");
-        print.str(stmt->getDecl()->getNameAsString()) << fmt::nbsp;
-        cprint.printStmt(stmt->getSubStmt(), print);
-        print.end_ctor();
+                        ClangPrinter &cprint, ASTContext &ctxt) {
+        visit_open(stmt, print, cprint, ctxt);
     }
 
     void VisitGotoStmt(const GotoStmt *stmt, CoqPrinter &print,
@@ -350,6 +420,16 @@ PrintStmt PrintStmt::printer;
 void
 ClangPrinter::printStmt(const clang::Stmt *stmt, CoqPrinter &print) {
     __attribute__((unused)) auto depth = print.output().get_depth();
-    PrintStmt::printer.Visit(stmt, print, *this, *this->context_);
+    PrintStmt::printer.print_stmt(stmt, print, *this, *this->context_);
     assert(depth == print.output().get_depth());
 }
+
+void
+ClangPrinter::printBody(const clang::Stmt *body, CoqPrinter &print) {
+    if (bodies_ and not print.templates()) {
+        bodies_->print(print,
+                       [&](CoqPrinter &print) { printStmt(body, print); });
+    } else {
+        printStmt(body, print);
+    }
+}
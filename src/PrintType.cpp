@@ -6,6 +6,7 @@
 #include "ClangPrinter.hpp"
 #include "CoqPrinter.hpp"
 #include "Logging.hpp"
+#include "SharedTypes.hpp"
 #include "TypeVisitorWithArgs.h"
 #include "config.hpp"
 #include "clang/AST/ASTContext.h"
@@ -476,6 +477,50 @@ ClangPrinter::printType(const clang::Type* type, CoqPrinter& print) {
 
 void
 ClangPrinter::printQualType(const QualType& qt, CoqPrinter& print) {
+    if (types_ and not print.templates()) {
+        types_->print(qt, print,
+                      [&](CoqPrinter& print) { printQualTypeText(qt, print); });
+        return;
+    }
+
+    auto& out = print.output();
+    auto before = out.state();
+    if (before.blank) {
+        // The text would start with the indentation of the line.
+        printQualTypeText(qt, print);
+        return;
+    }
+    unsigned layout = before.spaces << 3 | unsigned(before.open) << 2 |
+                      unsigned(before.compact) << 1 |
+                      unsigned(print.templates());
+    TypeCache::Key key{qt.getAsOpaquePtr(), names_, layout};
+    auto i = type_cache_.types.find(key);
+    if (i != type_cache_.types.end()) {
+        ++type_cache_.hits;
+        auto after = i->second.after;
+        after.depth = before.depth;
+        out.splice(i->second.text, after);
+        return;
+    }
+
+    ++type_cache_.misses;
+    std::string text;
+    llvm::raw_string_ostream os(text);
+    fmt::Formatter fmt(os, before, 0);
+    CoqPrinter sub(fmt, print.templates());
+    printQualTypeText(qt, sub);
+    os.flush();
+    auto after = fmt.state();
+    out.splice(text, after);
+    if (after.depth == before.depth and
+        llvm::StringRef(text).find('\n') == llvm::StringRef::npos) {
+        type_cache_.types.try_emplace(key, TypeCache::Entry{std::move(text),
+                                                            after});
+    }
+}
+
+void
+ClangPrinter::printQualTypeText(const QualType& qt, CoqPrinter& print) {
     if (auto p = qt.getTypePtrOrNull()) {
         if (qt.isLocalConstQualified()) {
             if (qt.isVolatileQualified()) {
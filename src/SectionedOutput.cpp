@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "SectionedOutput.hpp"
+#include "Logging.hpp"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cassert>
+
+namespace fs = llvm::sys::fs;
+
+struct SectionedOutput::Spill {
+    std::string path;
+    llvm::raw_fd_ostream file;
+    fmt::Formatter out;
+    CoqPrinter print;
+
+    Spill(llvm::StringRef path, int fd, fmt::Formatter::State start,
+          bool templates)
+        : path(path.str()), file(fd, /*shouldClose=*/true), out(file, start),
+          print(out, templates) {}
+};
+
+std::unique_ptr<SectionedOutput>
+SectionedOutput::open(const std::string& path, unsigned sections,
+                      bool compact, bool templates) {
+    std::error_code ec;
+    auto file = std::make_unique<llvm::raw_fd_ostream>(path, ec);
+    if (ec) {
+        llvm::errs() << path << ": " << ec.message() << "\n";
+        return nullptr;
+    }
+    return std::unique_ptr<SectionedOutput>(
+        new SectionedOutput(std::move(file), sections, compact, templates));
+}
+
+static fmt::Formatter::State
+start_state(bool compact) {
+    fmt::Formatter::State start;
+    start.compact = compact;
+    return start;
+}
+
+SectionedOutput::SectionedOutput(std::unique_ptr<llvm::raw_fd_ostream> file,
+                                 unsigned sections, bool compact,
+                                 bool templates)
+    : file_(std::move(file)), out_(*file_, start_state(compact)),
+      print_(out_, templates), spills_(sections) {}
+
+SectionedOutput::~SectionedOutput() {
+    for (auto& spill : spills_) {
+        if (spill) {
+            fs::remove(spill->path);
+        }
+    }
+}
+
+CoqPrinter&
+SectionedOutput::section(unsigned section) {
+    assert(current_ <= section and section < spills_.size());
+    if (section == current_) {
+        return print_;
+    }
+
+    auto& spill = spills_[section];
+    if (not spill) {
+        // Every entry starts from the state between two list elements, so
+        // the text can be copied in at any such point.
+        llvm::SmallString<128> path;
+        int fd;
+        if (auto ec = fs::createTemporaryFile("cpp2v-section", "v", fd, path)) {
+            logging::fatal() << "cpp2v: cannot create a temporary file: "
+                             << ec.message() << "\n";
+            logging::die();
+        }
+        spill = std::make_unique<Spill>(path, fd, out_.state(),
+                                        print_.templates());
+    }
+    return spill->print;
+}
+
+void
+SectionedOutput::advance(unsigned section) {
+    for (auto next = current_ + 1; next <= section and next < spills_.size();
+         ++next) {
+        auto& spill = spills_[next];
+        if (not spill) {
+            continue;
+        }
+        spill->out.flush();
+        spill->file.close();
+        auto buf = llvm::MemoryBuffer::getFile(spill->path);
+        if (not buf) {
+            logging::fatal() << "cpp2v: cannot read back " << spill->path
+                             << ": " << buf.getError().message() << "\n";
+            logging::die();
+        }
+        // The section may have been started before the depth of the list was
+        // known (see [ToCoqConsumer::Printing::HEADER]).
+        auto after = spill->out.state();
+        after.depth = out_.state().depth;
+        out_.splice((*buf)->getBuffer(), after);
+        fs::remove(spill->path);
+        spill.reset();
+    }
+    current_ = std::max(current_, section);
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "SharedTypes.hpp"
+#include "CoqPrinter.hpp"
+#include "clang/AST/Type.h"
+#include "llvm/Support/raw_ostream.h"
+
+void
+SharedTypes::print(const clang::QualType& qt, CoqPrinter& print,
+                   llvm::function_ref<void(CoqPrinter&)> print_type) {
+    auto it = printed_.find(qt.getAsOpaquePtr());
+    if (it == printed_.end()) {
+        std::string text;
+        llvm::raw_string_ostream os(text);
+        fmt::Formatter::State start;
+        start.compact = print.output().state().compact;
+        {
+            fmt::Formatter out(os, start, 0);
+            CoqPrinter type_print(out, print.templates());
+            print_type(type_print);
+        }
+        os.flush();
+
+        auto name = "ty_" + std::to_string(definitions_.size());
+        if (text.size() <= name.size()) {
+            it = printed_.try_emplace(qt.getAsOpaquePtr(), std::move(text))
+                     .first;
+        } else {
+            auto known = names_.try_emplace(text, definitions_.size());
+            if (known.second) {
+                definitions_.push_back(std::move(text));
+            } else {
+                name = "ty_" + std::to_string(known.first->second);
+            }
+            it = printed_.try_emplace(qt.getAsOpaquePtr(), std::move(name))
+                     .first;
+        }
+    }
+    print.output() << it->second;
+}
+
+void
+SharedTypes::print_definitions(CoqPrinter& print) const {
+    for (size_t k = 0; k < definitions_.size(); ++k) {
+        print.output() << "Definition ty_" << k << " : type := "
+                       << definitions_[k] << "." << fmt::line;
+    }
+}
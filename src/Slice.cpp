@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "Slice.hpp"
+#include "ModuleBuilder.hpp"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/Regex.h"
+#include <vector>
+
+using namespace clang;
+
+namespace {
+// The declarations that the body, initializer or type of a declaration
+// refers to.
+class References : public RecursiveASTVisitor<References> {
+public:
+    References(const ASTContext& ctxt, std::vector<const Decl*>& found)
+        : ctxt_(ctxt), found_(found) {}
+
+    bool shouldVisitImplicitCode() const {
+        return true;
+    }
+    bool shouldVisitTemplateInstantiations() const {
+        return true;
+    }
+
+    void add(const Decl* d) {
+        if (d) {
+            found_.push_back(d);
+        }
+    }
+
+    void addType(QualType qt) {
+        while (not qt.isNull()) {
+            auto t = qt.getTypePtr();
+            if (auto td = dyn_cast<TypedefType>(t)) {
+                add(td->getDecl());
+            } else if (auto tag = dyn_cast<TagType>(t)) {
+                add(tag->getDecl());
+                return;
+            } else if (auto fn = dyn_cast<FunctionProtoType>(t)) {
+                for (auto param : fn->getParamTypes()) {
+                    addType(param);
+                }
+                qt = fn->getReturnType();
+                continue;
+            } else if (auto mp = dyn_cast<MemberPointerType>(t)) {
+                addType(QualType(mp->getClass(), 0));
+                qt = mp->getPointeeType();
+                continue;
+            } else if (auto array = dyn_cast<ArrayType>(t)) {
+                qt = array->getElementType();
+                continue;
+            } else if (not t->getPointeeType().isNull()) {
+                qt = t->getPointeeType();
+                continue;
+            }
+            auto next = qt.getSingleStepDesugaredType(ctxt_);
+            if (next == qt) {
+                return;
+            }
+            qt = next;
+        }
+    }
+
+    bool VisitExpr(Expr* e) {
+        addType(e->getType());
+        return true;
+    }
+    bool VisitDeclRefExpr(DeclRefExpr* e) {
+        add(e->getDecl());
+        return true;
+    }
+    bool VisitMemberExpr(MemberExpr* e) {
+        add(e->getMemberDecl());
+        return true;
+    }
+    bool VisitCXXConstructExpr(CXXConstructExpr* e) {
+        add(e->getConstructor());
+        return true;
+    }
+    bool VisitCXXNewExpr(CXXNewExpr* e) {
+        add(e->getOperatorNew());
+        add(e->getOperatorDelete());
+        addType(e->getAllocatedType());
+        return true;
+    }
+    bool VisitCXXDeleteExpr(CXXDeleteExpr* e) {
+        add(e->getOperatorDelete());
+        addType(e->getDestroyedType());
+        return true;
+    }
+    bool VisitUnaryExprOrTypeTraitExpr(UnaryExprOrTypeTraitExpr* e) {
+        if (e->isArgumentType()) {
+            addType(e->getArgumentType());
+        }
+        return true;
+    }
+    bool VisitExplicitCastExpr(ExplicitCastExpr* e) {
+        addType(e->getTypeAsWritten());
+        return true;
+    }
+    bool VisitValueDecl(ValueDecl* d) {
+        addType(d->getType());
+        return true;
+    }
+    bool VisitTypedefNameDecl(TypedefNameDecl* d) {
+        addType(d->getUnderlyingType());
+        return true;
+    }
+    bool TraverseConstructorInitializer(CXXCtorInitializer* init) {
+        if (auto base = init->getBaseClass()) {
+            addType(QualType(base, 0));
+        }
+        add(init->getAnyMember());
+        return RecursiveASTVisitor::TraverseConstructorInitializer(init);
+    }
+
+private:
+    const ASTContext& ctxt_;
+    std::vector<const Decl*>& found_;
+};
+} // namespace
+
+// Add what [decl] refers to, without the rest of its declaration context,
+// to [found].
+void
+references(const Decl* decl, std::vector<const Decl*>& found) {
+    References refs(decl->getASTContext(), found);
+    auto d = const_cast<Decl*>(decl);
+
+    if (auto rd = dyn_cast<CXXRecordDecl>(decl)) {
+        // Not its members: only what the [Struct] of the class mentions,
+        // and what using it implies.
+        if (not rd->hasDefinition()) {
+            return;
+        }
+        rd = rd->getDefinition();
+        for (auto& base : rd->bases()) {
+            refs.addType(base.getType());
+        }
+        for (auto field : rd->fields()) {
+            refs.add(field);
+            refs.addType(field->getType());
+        }
+        refs.add(rd->getDestructor());
+        if (rd->isDynamicClass()) {
+            for (auto method : rd->methods()) {
+                if (method->isVirtual()) {
+                    refs.add(method);
+                }
+            }
+        }
+    } else if (auto rd = dyn_cast<RecordDecl>(decl)) {
+        for (auto field : rd->fields()) {
+            refs.addType(field->getType());
+        }
+    } else if (auto ed = dyn_cast<EnumDecl>(decl)) {
+        refs.addType(ed->getIntegerType());
+        for (auto c : ed->enumerators()) {
+            refs.add(c);
+        }
+    } else if (auto fd = dyn_cast<FieldDecl>(decl)) {
+        refs.add(fd->getParent());
+    } else if (isa<EnumConstantDecl>(decl)) {
+        refs.add(cast<Decl>(decl->getDeclContext()));
+    } else {
+        if (auto md = dyn_cast<CXXMethodDecl>(decl)) {
+            refs.add(md->getParent());
+            for (auto o : md->overridden_methods()) {
+                refs.add(o);
+            }
+        }
+        if (auto fd = dyn_cast<FunctionDecl>(decl)) {
+            // The definition, which the module prints.
+            if (auto def = fd->getDefinition()) {
+                d = const_cast<FunctionDecl*>(def);
+            }
+        }
+        if (auto vd = dyn_cast<VarDecl>(decl)) {
+            if (auto def = vd->getDefinition()) {
+                d = def;
+            }
+        }
+        refs.TraverseDecl(d);
+    }
+}
+
+unsigned
+slice_module(::Module& mod, llvm::ArrayRef<std::string> roots,
+             ASTContext& ctxt) {
+    std::vector<llvm::Regex> patterns;
+    for (auto& root : roots) {
+        patterns.emplace_back("^(" + root + ")$");
+    }
+    auto is_root = [&](const NamedDecl* decl) {
+        auto name = decl->getQualifiedNameAsString();
+        return llvm::any_of(patterns,
+                            [&](auto& re) { return re.match(name); });
+    };
+
+    std::vector<const Decl*> work;
+    unsigned matched = 0;
+    for (auto list : {&mod.declarations(), &mod.definitions()}) {
+        for (auto decl : *list) {
+            if (is_root(decl)) {
+                work.push_back(decl);
+                ++matched;
+            }
+        }
+    }
+
+    llvm::DenseSet<const Decl*> reached;
+    while (not work.empty()) {
+        auto decl = work.back()->getCanonicalDecl();
+        work.pop_back();
+        if (reached.insert(decl).second) {
+            references(decl, work);
+        }
+    }
+
+    auto& sm = ctxt.getSourceManager();
+    mod.retain(
+        [&](const NamedDecl* decl) {
+            return reached.count(decl->getCanonicalDecl()) != 0;
+        },
+        [&](const StaticAssertDecl* decl) {
+            return sm.isInMainFile(sm.getExpansionLoc(decl->getLocation()));
+        });
+    return matched;
+}
@@ -12,15 +12,16 @@ using namespace fmt;
 /**
  * @brief Implement a FSM-based pretty-printer to Coq strings.
  *
- * We use native string notation for ASCII parts of the string, and encoded each
- * character for non-ASCII parts. For instance, "Welcome to BHV™" is encoded as
- * "Welcome to BHV" ++ (BS.String Byte.xe2 (BS.String Byte.x84 (BS.String Byte.xa2 BS.EmptyString))).
+ * We use native string notation for the printable ASCII parts of the string,
+ * and encode each run of other bytes as the list of its bytes. For instance,
+ * "Welcome to BHV™" is encoded as
+ * ("Welcome to BHV" ++ (BS.parse [Byte.xe2; Byte.x84; Byte.xa2])).
  *
  * In examples like these, we could use native string notation even for ™; but
  * this only works for valid UTF-8 encodings, so we don't bother.
  *
  * Switching between the "native" and "encoded" sections requires care to close
- * and quotes/parens, and output " ++ " if needed.
+ * any quotes/brackets, and output " ++ " if needed.
  * This is handled by StringPrettyPrinter::switch_st.
 
  * We present the code top-down.
@@ -54,7 +55,7 @@ public:
 
 private:
     static bool printable(unsigned char c) {
-        return (32 <= c) && (c < 128);
+        return (32 <= c) && (c < 127);
     }
 
     void toLit(unsigned char c) {
@@ -71,18 +72,23 @@ private:
 
     /**
      * @brief Pretty-prints a special character c as encoded.
-     * For instance, "\xe2" is encoded by printing "(BS.String Byte.xe2", and deferring ")".
+     * For instance, "\xe2" is encoded by printing "Byte.xe2" as an element of
+     * the list of the current run.
      */
     void toEscape(unsigned char c) {
         switch_st(PrettyState::ESCAPE);
 
         char buf[25];
         snprintf(buf, sizeof buf, "%02x", c);
-        print.output() << "(BS.String Byte.x" << buf << " ";
-        parens_to_close++;
+        if (0 < escaped) {
+            print.output() << "; ";
+        }
+        print.output() << "Byte.x" << buf;
+        escaped++;
     }
-    // Count open parens to close. The value is -1 iff state is not PrettyState::ESCAPE.
-    int parens_to_close{-1};
+    // The number of bytes in the current run. The value is -1 iff state is
+    // not PrettyState::ESCAPE.
+    int escaped{-1};
 
     enum class PrettyState { NONE, LIT, ESCAPE };
     // We use PrettyState::NONE only at the beginning.
@@ -92,10 +98,10 @@ private:
      * @brief Switch to new pretty-printing state.
      * If we're switching state, and there is an active section (state !=
      * PrettyState::NONE), we must:
-     * - close any open quotes or parentheses.
+     * - close any open quotes or brackets.
      * - output " ++ "
-     * We must then "open" the new state (output the opening quote, or reset the
-     * parenthesis count).
+     * We must then "open" the new state (output the opening quote, or the
+     * start of the list of bytes).
      *
      * @param new_st (not PrettyState::NONE).
      */
@@ -114,7 +120,7 @@ private:
     }
 
     /**
-     * @brief Print any closing quotes/parentheses to switch away from the current state.
+     * @brief Print any closing quotes/brackets to switch away from the current state.
      */
     void close() {
         switch (state) {
@@ -125,14 +131,8 @@ private:
             print.output() << "\"";
             break;
         case PrettyState::ESCAPE:
-            // print.output() << "BS.EmptyString";
-            print.output() << "\"\"";
-
-            for (auto i = 0; i < parens_to_close; i++) {
-                print.output() << ")";
-            }
-            parens_to_close = -1;
-
+            print.output() << "])";
+            escaped = -1;
             break;
         }
     }
@@ -146,8 +146,9 @@ private:
             print.output() << "\"";
             break;
         case PrettyState::ESCAPE:
-            assert(parens_to_close == -1);
-            parens_to_close = 0;
+            assert(escaped == -1);
+            print.output() << "(BS.parse [";
+            escaped = 0;
             break;
         case PrettyState::NONE:
             assert(false);
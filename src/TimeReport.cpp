@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+#include "TimeReport.hpp"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <time.h>
+
+static const char* const NAMES[TimeReport::PHASES] = {
+    "frontend",
+    "elaborate: top-level declarations",
+    "elaborate: tag definitions",
+    "elaborate: template specializations",
+    "elaborate: inline functions",
+    "elaborate: implicit instantiations",
+    "elaborate: on demand",
+    "build module",
+    "print module",
+    "print names",
+    "print templates",
+    "save declaration cache",
+};
+
+TimeReport::Time
+TimeReport::now() {
+    auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+    struct timespec cpu = {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+    return Time{uint64_t(wall.count()),
+                uint64_t(cpu.tv_sec) * 1000000000 + uint64_t(cpu.tv_nsec)};
+}
+
+TimeReport::TimeReport(bool json) : json_(json), last_(now()) {
+    phases_[FRONTEND].calls = 1;
+}
+
+void
+TimeReport::charge() {
+    auto t = now();
+    auto& phase = phases_[current_].time;
+    phase.wall_ns += t.wall_ns - last_.wall_ns;
+    phase.cpu_ns += t.cpu_ns - last_.cpu_ns;
+    last_ = t;
+}
+
+TimeReport::Scope::Scope(TimeReport* report, Phase phase) : report_(report) {
+    if (report_) {
+        report_->charge();
+        outer_ = report_->current_;
+        report_->current_ = phase;
+        report_->phases_[phase].calls++;
+    }
+}
+
+TimeReport::Scope::~Scope() {
+    if (report_) {
+        report_->charge();
+        report_->current_ = outer_;
+    }
+}
+
+void
+TimeReport::cache(const char* name, uint64_t hits, uint64_t misses) {
+    caches_.push_back(Cache{name, hits, misses});
+}
+
+void
+TimeReport::count(const char* name, uint64_t n) {
+    counts_.emplace_back(name, n);
+}
+
+void
+TimeReport::print(llvm::raw_ostream& os, llvm::StringRef file) {
+    charge();
+    Time total{0, 0};
+    for (auto& p : phases_) {
+        total.wall_ns += p.time.wall_ns;
+        total.cpu_ns += p.time.cpu_ns;
+    }
+    auto secs = [](uint64_t ns) { return double(ns) / 1e9; };
+    auto rate = [](const Cache& c) {
+        auto lookups = c.hits + c.misses;
+        return lookups == 0 ? 0.0 : 100.0 * double(c.hits) / double(lookups);
+    };
+
+    if (json_) {
+        llvm::json::OStream json(os);
+        json.object([&] {
+            json.attribute("file", file);
+            json.attribute("wall", secs(total.wall_ns));
+            json.attribute("cpu", secs(total.cpu_ns));
+            json.attributeArray("phases", [&] {
+                for (int i = 0; i < PHASES; ++i) {
+                    json.object([&] {
+                        json.attribute("phase", NAMES[i]);
+                        json.attribute("wall", secs(phases_[i].time.wall_ns));
+                        json.attribute("cpu", secs(phases_[i].time.cpu_ns));
+                        json.attribute("calls", int64_t(phases_[i].calls));
+                    });
+                }
+            });
+            json.attributeArray("caches", [&] {
+                for (auto& c : caches_) {
+                    json.object([&] {
+                        json.attribute("cache", c.name);
+                        json.attribute("hits", int64_t(c.hits));
+                        json.attribute("misses", int64_t(c.misses));
+                        json.attribute("rate", rate(c));
+                    });
+                }
+            });
+            json.attributeObject("counts", [&] {
+                for (auto& [name, n] : counts_) {
+                    json.attribute(name, int64_t(n));
+                }
+            });
+        });
+        os << "\n";
+        return;
+    }
+
+    os << "===== cpp2v time report: " << file << " =====\n"
+       << "  Wall (s)    CPU (s)    Calls  Phase\n";
+    for (int i = 0; i < PHASES; ++i) {
+        os << llvm::format("%10.4f %10.4f %8u  %s\n",
+                           secs(phases_[i].time.wall_ns),
+                           secs(phases_[i].time.cpu_ns), phases_[i].calls,
+                           NAMES[i]);
+    }
+    os << llvm::format("%10.4f %10.4f", secs(total.wall_ns),
+                       secs(total.cpu_ns))
+       << "           total\n";
+
+    if (not caches_.empty()) {
+        os << "      Hits     Misses     Rate  Cache\n";
+        for (auto& c : caches_) {
+            os << llvm::format("%10llu %10llu %7.1f%%  %s\n",
+                               (unsigned long long)c.hits,
+                               (unsigned long long)c.misses, rate(c), c.name);
+        }
+    }
+
+    if (not counts_.empty()) {
+        os << "                         Count  What\n";
+        for (auto& [name, n] : counts_) {
+            os << llvm::format("%30llu  %s\n", (unsigned long long)n, name);
+        }
+    }
+}
@@ -3,11 +3,23 @@
  * This software is distributed under the terms of the BedRock Open-Source License.
  * See the LICENSE-BedRock file in the repository root for details.
  */
+#include "CanonicalTables.hpp"
 #include "ClangPrinter.hpp"
 #include "CommentScanner.hpp"
 #include "CoqPrinter.hpp"
+#include "DeclCache.hpp"
+#include "DeclProfile.hpp"
+#include "Elaborate.hpp"
 #include "Filter.hpp"
+#include "FilterSpec.hpp"
+#include "HeaderModules.hpp"
+#include "InternedNames.hpp"
+#include "LazyBodies.hpp"
+#include "Logging.hpp"
 #include "ModuleBuilder.hpp"
+#include "SectionedOutput.hpp"
+#include "SharedTypes.hpp"
+#include "Slice.hpp"
 #include "SpecCollector.hpp"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
@@ -16,8 +28,12 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/Version.inc"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/xxhash.h"
 #include <Formatter.hpp>
+#include <array>
 #include <list>
+#include <map>
 
 #include "clang/AST/ASTConsumer.h"
 #include "clang/Frontend/CompilerInstance.h"
@@ -49,9 +65,416 @@ with_open_file(const std::optional<std::string> path,
 }
 
 void
-printDecl(const clang::Decl* decl, CoqPrinter& print, ClangPrinter& cprint) {
-    if (cprint.printDecl(decl, print))
+printDecl(const clang::Decl* decl, CoqPrinter& print, ClangPrinter& cprint,
+          DeclCache* cache, DeclProfile* profile) {
+    DeclProfile::Start start{};
+    if (profile)
+        start = profile->start(print.output());
+    if (cache ? cache->printDecl(decl, print, cprint)
+              : cprint.printDecl(decl, print)) {
+        if (profile)
+            profile->record(decl, print.output(), print.templates(), start);
         print.cons();
+    }
+}
+
+static const char*
+endian_of(const clang::ASTContext& ctxt) {
+    if (ctxt.getTargetInfo().isBigEndian()) {
+        return "Big";
+    }
+    assert(ctxt.getTargetInfo().isLittleEndian());
+    return "Little";
+}
+
+// Start the list of declarations of a module, or of a part of it. With
+// [bodies], the list is a function of them (see LazyBodies.hpp).
+static void
+print_module_start(CoqPrinter& print, llvm::StringRef name,
+                   const char* reduction,
+                   const LazyBodies* bodies = nullptr) {
+    if (bodies) {
+        print.output() << fmt::line << "Definition " << name << " :="
+                       << fmt::indent << fmt::line << "Eval " << reduction
+                       << " in fun";
+        bodies->print_names(print);
+        print.output() << " : Stmt =>" << fmt::line << "decls" << fmt::nbsp;
+    } else {
+        print.output() << fmt::line << "Definition " << name
+                       << " : translation_unit := " << fmt::indent << fmt::line
+                       << "Eval " << reduction << " in decls" << fmt::nbsp;
+    }
+
+    print.begin_list();
+}
+
+// With [--reduction=lazy-per-chunk], the number of entries that coqc reduces
+// at a time.
+static const unsigned lazy_part_size = 64;
+
+// The entries of a growing list that have not been printed yet.
+template<typename List>
+class Pending {
+public:
+    explicit Pending(const List& list) : list_(list) {}
+
+    template<typename F>
+    void each(F f) {
+        auto i = last_.has_value() ? std::next(*last_) : list_.begin();
+        for (; i != list_.end(); ++i) {
+            f(*i);
+            last_ = i;
+        }
+    }
+
+private:
+    const List& list_;
+    std::optional<typename List::const_iterator> last_;
+};
+
+// Everything needed while the module and templates are printed. Without
+// [--stream], it only lives during [toCoqModule]; with [--stream], the first
+// top-level declaration group creates it.
+struct ToCoqConsumer::Printing {
+    // The sections of the module and templates outputs, in order. With
+    // [--share-types], the header of the module ends with the definitions of
+    // the types, so it is only printed once all entries have been.
+    enum Section { HEADER, DECLARATIONS, DEFINITIONS, ASSERTS, SECTIONS };
+
+    SpecCollector specs;
+    // Everything, or what the [--filter] spec selects.
+    std::unique_ptr<Filter> filter;
+    ::Module mod;
+    ModuleBuilder builder;
+
+    std::optional<DeclCache> cache;
+    std::optional<DeclProfile> profile;
+
+    // The module, or its chunks with [--chunks]. Null where the file could
+    // not be opened. The chunks share one printer so that they agree on the
+    // numbering of unnamed entities.
+    std::vector<std::unique_ptr<SectionedOutput>> modules;
+    ClangPrinter module_cprint;
+    // With [--intern-names] and [--share-types], the names and types of each
+    // of [modules].
+    std::vector<InternedNames> names;
+    std::vector<SharedTypes> types;
+    // With [--lazy-bodies], the function bodies of each of [modules].
+    std::vector<LazyBodies> bodies;
+    // With [--header-modules], where the entries from included files go.
+    std::optional<HeaderModules> headers;
+    // With [--canonical-tables], where the entries of the module go instead.
+    std::optional<CanonicalTables> tables;
+    // With [--reduction=lazy-per-chunk], the list of declarations of each of
+    // [modules] is cut into sub-lists of [part_size] entries of a section,
+    // which coqc reduces separately. [entries] counts the entries of each
+    // section of each module.
+    unsigned part_size{0};
+    std::vector<std::array<unsigned, SECTIONS>> entries;
+    const char* reduction{nullptr};
+    const char* endian{nullptr};
+    // With [--chunks], the index of each declaration without a name among
+    // those of its kind in its context (see [print_place]).
+    llvm::DenseMap<const Decl*, unsigned> unnamed_index;
+    std::unique_ptr<SectionedOutput> templates;
+    ClangPrinter templates_cprint;
+
+    Pending<::Module::DeclList> declarations{mod.declarations()};
+    Pending<::Module::DeclList> definitions{mod.definitions()};
+    Pending<::Module::AssertList> asserts{mod.asserts()};
+    Pending<::Module::DeclList> template_declarations{
+        mod.template_declarations()};
+    Pending<::Module::DeclList> template_definitions{
+        mod.template_definitions()};
+
+    static std::unique_ptr<Filter> make_filter(const FilterSpec* spec,
+                                               const SourceManager& sm) {
+        if (spec) {
+            return std::make_unique<SpecFilter>(*spec, sm);
+        }
+        return std::make_unique<Default>(Filter::What::DEFINITION);
+    }
+
+    Printing(clang::CompilerInstance* compiler, clang::ASTContext* ctxt,
+             bool templates, const FilterSpec* filter_spec,
+             bool header_modules)
+        : filter(make_filter(filter_spec, ctxt->getSourceManager())),
+          builder(mod, *filter, specs, compiler, templates, header_modules),
+          module_cprint(compiler, ctxt), templates_cprint(compiler, ctxt) {
+        templates_cprint.share_names(module_cprint);
+    }
+
+    // The definition that the list of declarations of a module starts in.
+    const char* first_part() const {
+        if (headers) {
+            return "module_own";
+        }
+        return 0 < part_size ? "module_part" : "module";
+    }
+    // The name of the [j]th sub-list started in [section].
+    static std::string part_name(Section section, unsigned j) {
+        return (llvm::Twine("module_part_") + llvm::Twine(unsigned(section)) +
+                "_" + llvm::Twine(j))
+            .str();
+    }
+
+    // The index in [modules] of the output that [decl] goes to.
+    unsigned module_for(const Decl* decl) {
+        if (modules.size() == 1) {
+            return 0;
+        }
+        // Entries printed under the same name must go to the same chunk, as
+        // the last one wins.
+        std::string name;
+        if (auto vd = dyn_cast<ValueDecl>(decl)) {
+            name = module_cprint.objName(vd);
+        } else if (auto td = dyn_cast<TagDecl>(decl)) {
+            name = module_cprint.typeName(td);
+        } else {
+            // Other declarations, such as typedefs and static assertions, are
+            // not printed under a name that can repeat: spread them by their
+            // kind and their name or, failing that, their place.
+            llvm::raw_string_ostream os(name);
+            os << decl->getDeclKindName() << ":";
+            auto nd = dyn_cast<NamedDecl>(decl);
+            if (nd and nd->getDeclName()) {
+                os << nd->getQualifiedNameAsString();
+            } else {
+                print_place(os, decl);
+            }
+            os.flush();
+        }
+        return llvm::xxHash64(name) % modules.size();
+    }
+
+    // The place of [decl], which has no name, that edits elsewhere do not
+    // change: the innermost named context around it, and how many unnamed
+    // declarations of its kind come before it there.
+    void print_place(llvm::raw_ostream& os, const Decl* decl) {
+        auto dc = decl->getLexicalDeclContext();
+        auto it = unnamed_index.find(decl);
+        if (it == unnamed_index.end()) {
+            // With [--stream], [dc] may have grown since it was counted.
+            std::map<Decl::Kind, unsigned> counts;
+            for (auto d : dc->decls()) {
+                auto nd = dyn_cast<NamedDecl>(d);
+                if (not nd or not nd->getDeclName()) {
+                    unnamed_index[d] = counts[d->getKind()]++;
+                }
+            }
+            it = unnamed_index.find(decl);
+        }
+        for (auto c = dc; c; c = c->getLexicalParent()) {
+            auto nd = dyn_cast<NamedDecl>(c);
+            if (nd and nd->getDeclName()) {
+                os << nd->getQualifiedNameAsString();
+                break;
+            }
+        }
+        os << "#" << (it == unnamed_index.end() ? 0 : it->second);
+    }
+
+    // Select the names, types and bodies of module [k] and return the
+    // printer for [section] of it, if it could be opened.
+    CoqPrinter* module_section(unsigned k, Section section) {
+        module_cprint.intern_names(names.empty() ? nullptr : &names[k]);
+        module_cprint.share_types(types.empty() ? nullptr : &types[k]);
+        module_cprint.lazy_bodies(bodies.empty() ? nullptr : &bodies[k]);
+        if (tables) {
+            return &tables->entry();
+        }
+        auto out = modules[k].get();
+        if (not out) {
+            return nullptr;
+        }
+        auto& print = out->section(section);
+        if (0 < part_size) {
+            auto& n = entries[k][section];
+            if (0 < n and n % part_size == 0) {
+                print.end_list();
+                print.output() << fmt::nbsp << endian << "." << fmt::outdent;
+                print_module_start(print, part_name(section, n / part_size),
+                                   reduction);
+            }
+            ++n;
+        }
+        return &print;
+    }
+
+    DeclCache* cachep() {
+        return cache.has_value() ? &*cache : nullptr;
+    }
+    DeclProfile* profilep() {
+        return profile.has_value() ? &*profile : nullptr;
+    }
+};
+
+ToCoqConsumer::ToCoqConsumer(clang::CompilerInstance* compiler,
+                             ToCoqOptions options)
+    : compiler_(compiler), options_(std::move(options)),
+      elaborator_(std::make_unique<Elaborator>(
+          compiler, options_.templates_file.has_value())) {
+    if (options_.time_report_json.has_value()) {
+        timing_.emplace(*options_.time_report_json);
+    }
+}
+
+ToCoqConsumer::~ToCoqConsumer() = default;
+
+std::string
+chunk_file(llvm::StringRef module_file, unsigned k) {
+    module_file.consume_back(".v");
+    return (module_file + "_part_" + llvm::Twine(k) + ".v").str();
+}
+
+std::string
+interned_names_file(llvm::StringRef module_file) {
+    module_file.consume_back(".v");
+    return (module_file + "_interned.tsv").str();
+}
+
+const char*
+ToCoqConsumer::reduction_name() const {
+    switch (options_.reduction) {
+    case Reduction::VM:
+        return "reduce_translation_unit";
+    case Reduction::NATIVE:
+        return "reduce_translation_unit_native";
+    case Reduction::LAZY_PER_CHUNK:
+        return "reduce_translation_unit_lazy";
+    }
+    llvm_unreachable("unknown reduction");
+}
+
+void
+ToCoqConsumer::startPrinting(clang::ASTContext* ctxt) {
+    printing_ = std::make_unique<Printing>(
+        compiler_, ctxt, options_.templates_file.has_value(),
+        options_.filter_spec.get(), options_.header_modules.has_value());
+    auto& p = *printing_;
+    if (options_.decl_cache.has_value()) {
+        p.cache.emplace(*options_.decl_cache, *ctxt);
+    }
+    if (options_.decl_profile.has_value() or 0 < options_.decl_profile_top) {
+        p.profile.emplace(*ctxt);
+    }
+
+    if (options_.output_file.has_value()) {
+        TimeReport::Scope timer(timing(), TimeReport::PRINT_MODULE);
+        p.reduction = reduction_name();
+        p.endian = endian_of(*ctxt);
+        if (options_.reduction == Reduction::LAZY_PER_CHUNK) {
+            p.part_size = lazy_part_size;
+        }
+        for (unsigned k = 0; k < std::max(options_.chunks, 1u); ++k) {
+            auto file = options_.chunks ? chunk_file(*options_.output_file, k)
+                                        : *options_.output_file;
+            auto out = SectionedOutput::open(file, Printing::SECTIONS,
+                                             options_.compact, false);
+            if (out) {
+                auto& print = out->printer();
+                print.output() << "Require Import bedrock.lang.cpp.parser."
+                               << fmt::line << fmt::line
+                               << "#[local] Open Scope bs_scope." << fmt::line;
+                // << "Import ListNotations." << fmt::line;
+
+                if (options_.canonical_tables) {
+                    print.output() << "Import table_entries." << fmt::line;
+                } else if (not defer_header()) {
+                    print_module_start(print, p.first_part(), p.reduction);
+                    out->advance(Printing::DECLARATIONS);
+                }
+            }
+            p.modules.push_back(std::move(out));
+        }
+        p.entries.resize(p.modules.size());
+        if (options_.intern_names) {
+            p.names.resize(p.modules.size());
+        }
+        if (options_.share_types) {
+            p.types.resize(p.modules.size());
+        }
+        if (options_.lazy_bodies) {
+            p.bodies.resize(p.modules.size());
+        }
+        if (options_.header_modules.has_value()) {
+            p.headers.emplace(ctxt->getSourceManager(),
+                              *options_.header_modules, options_.compact);
+        }
+        if (options_.canonical_tables) {
+            p.tables.emplace(options_.compact);
+        }
+    }
+
+    if (options_.templates_file.has_value()) {
+        p.templates =
+            SectionedOutput::open(*options_.templates_file, Printing::SECTIONS,
+                                  options_.compact, true);
+    }
+    if (p.templates) {
+        TimeReport::Scope timer(timing(), TimeReport::PRINT_TEMPLATES);
+        auto& print = p.templates->printer();
+        print.output() << "Require Import bedrock.auto.cpp.templates.mparser."
+                       << fmt::line << fmt::line
+                       << "#[local] Open Scope bs_scope." << fmt::line;
+
+        print.output()
+            << fmt::line
+            << "Definition templates : Mtranslation_unit :=" << fmt::indent
+            << fmt::line
+            << "Eval Mreduce_translation_unit in Mtranslation_unit.decls"
+            << fmt::nbsp;
+
+        print.begin_list();
+        p.templates->advance(Printing::DECLARATIONS);
+    }
+}
+
+void
+ToCoqConsumer::printPending() {
+    auto& p = *printing_;
+    auto cache = p.cachep();
+    auto profile = p.profilep();
+
+    if (not p.modules.empty()) {
+        TimeReport::Scope timer(timing(), TimeReport::PRINT_MODULE);
+        auto print = [&](Printing::Section section, const Decl* decl) {
+            if (auto print = p.module_section(p.module_for(decl), section)) {
+                printDecl(decl, *print, p.module_cprint, cache, profile);
+            }
+        };
+        p.declarations.each(
+            [&](auto decl) { print(Printing::DECLARATIONS, decl); });
+        p.definitions.each(
+            [&](auto decl) { print(Printing::DEFINITIONS, decl); });
+        p.asserts.each([&](auto decl) { print(Printing::ASSERTS, decl); });
+    }
+
+    if (auto out = p.templates.get()) {
+        TimeReport::Scope timer(timing(), TimeReport::PRINT_TEMPLATES);
+        auto print = [&](Printing::Section section, const Decl* decl) {
+            printDecl(decl, out->section(section), p.templates_cprint, cache,
+                      profile);
+        };
+        p.template_declarations.each(
+            [&](auto decl) { print(Printing::DECLARATIONS, decl); });
+        p.template_definitions.each(
+            [&](auto decl) { print(Printing::DEFINITIONS, decl); });
+    }
+}
+
+void
+ToCoqConsumer::stream(DeclGroupRef group) {
+    if (not printing_) {
+        startPrinting(&compiler_->getASTContext());
+    }
+    {
+        TimeReport::Scope timer(timing(), TimeReport::BUILD_MODULE);
+        for (auto decl : group) {
+            printing_->builder.add_final(decl);
+        }
+    }
+    printPending();
 }
 
 void
@@ -65,54 +488,214 @@ ToCoqConsumer::toCoqModule(clang::ASTContext* ctxt,
     filters.push_back(&fromComment);
     Combine<Filter::What::NOTHING, Filter::max> filter(filters);
 #endif
-    SpecCollector specs;
-    Default filter(Filter::What::DEFINITION);
+    if (not printing_) {
+        startPrinting(ctxt);
+    }
+    auto& p = *printing_;
+    auto& mod = p.mod;
 
-    ::Module mod;
+    if (options_.lazy_elaboration and options_.elaborate) {
+        TimeReport::Scope timer(timing(), TimeReport::ELAB_ON_DEMAND);
+        elaborator_->demand(decl, *p.filter);
+    }
 
-    bool templates = templates_file_.has_value();
-    build_module(decl, mod, filter, specs, compiler_, elaborate_, templates);
+    {
+        TimeReport::Scope timer(timing(), TimeReport::BUILD_MODULE);
+        p.builder.finish(decl);
+        if (not options_.roots.empty() and
+            slice_module(mod, options_.roots, *ctxt) == 0) {
+            logging::log(logging::NONE)
+                << "cpp2v: warning: no declaration matches --roots\n";
+        }
+    }
 
-    with_open_file(output_file_, [this, &ctxt, &mod](Formatter& fmt) {
-        CoqPrinter print(fmt, false);
-        ClangPrinter cprint(compiler_, ctxt);
+    const char* endian = endian_of(*ctxt);
 
-        fmt << "Require Import bedrock.lang.cpp.parser." << fmt::line
-            << fmt::line << "#[local] Open Scope bs_scope." << fmt::line;
-        // << "Import ListNotations." << fmt::line;
+    // Without [--stream], nothing has been printed yet, and each section is
+    // printed straight to the file (unless the header is deferred).
+    if (not p.modules.empty()) {
+        TimeReport::Scope timer(timing(), TimeReport::PRINT_MODULE);
+        auto print_decl = [&](Printing::Section section, const Decl* decl) {
+            if (auto print = p.headers ? p.headers->entry(decl) : nullptr) {
+                printDecl(decl, *print, p.module_cprint, p.cachep(),
+                          p.profilep());
+            } else if (auto print =
+                           p.module_section(p.module_for(decl), section)) {
+                printDecl(decl, *print, p.module_cprint, p.cachep(),
+                          p.profilep());
+                if (p.tables) {
+                    p.tables->add(decl, p.module_cprint);
+                }
+            }
+        };
+        auto advance = [&](Printing::Section section) {
+            for (auto& out : p.modules) {
+                if (out and not defer_header()) {
+                    out->advance(section);
+                }
+            }
+        };
+        p.declarations.each(
+            [&](auto decl) { print_decl(Printing::DECLARATIONS, decl); });
+        advance(Printing::DEFINITIONS);
+        p.definitions.each(
+            [&](auto decl) { print_decl(Printing::DEFINITIONS, decl); });
+        advance(Printing::ASSERTS);
+        p.asserts.each(
+            [&](auto decl) { print_decl(Printing::ASSERTS, decl); });
 
-        fmt << fmt::line
-            << "Definition module : translation_unit := " << fmt::indent
-            << fmt::line << "Eval reduce_translation_unit in decls"
-            << fmt::nbsp;
+        for (unsigned k = 0; k < p.modules.size(); ++k) {
+            auto out = p.modules[k].get();
+            if (not out) {
+                continue;
+            }
+            auto& print = out->printer();
+            if (defer_header()) {
+                print.output() << fmt::line;
+            }
+            if (options_.intern_names) {
+                p.names[k].print_definitions(print);
+            }
+            if (options_.share_types) {
+                p.types[k].print_definitions(print);
+            }
+            if (p.tables) {
+                p.tables->print(print, p.reduction, endian);
+                continue;
+            }
+            auto bodies = p.bodies.empty() or p.bodies[k].empty()
+                              ? nullptr
+                              : &p.bodies[k];
+            if (bodies) {
+                bodies->print_definitions(print);
+                print_module_start(print, "module_shape", p.reduction, bodies);
+            } else if (defer_header()) {
+                print_module_start(print, p.first_part(), p.reduction);
+            }
+            out->advance(Printing::SECTIONS);
 
-        print.begin_list();
-        for (auto decl : mod.declarations()) {
-            printDecl(decl, print, cprint);
-        }
-        for (auto decl : mod.definitions()) {
-            printDecl(decl, print, cprint);
-        }
-        for (auto decl : mod.asserts()) {
-            printDecl(decl, print, cprint);
+            print.end_list();
+            print.output() << fmt::nbsp << endian;
+
+            // TODO I still need to generate the initializer
+
+            print.output() << "." << fmt::outdent << fmt::line;
+
+            if (p.headers) {
+                auto headers = p.headers->write(p.reduction, endian);
+                if (not headers.empty()) {
+                    print.output() << fmt::line << "Require";
+                    for (auto& header : headers) {
+                        print.output() << fmt::nbsp << header;
+                    }
+                    print.output() << "." << fmt::line;
+                }
+                std::vector<std::string> parts{p.first_part()};
+                for (auto& header : headers) {
+                    parts.push_back(header + ".module");
+                }
+                print.output()
+                    << fmt::line << "Definition module : translation_unit := "
+                    << fmt::indent << fmt::line << "Eval " << p.reduction
+                    << " in link_translation_units" << fmt::nbsp;
+                print.list_range(parts.begin(), parts.end(),
+                                 [](auto& print, auto& part) {
+                                     print.output() << part;
+                                 });
+                print.output() << fmt::nbsp << endian << "." << fmt::outdent
+                               << fmt::line;
+            }
+
+            if (bodies) {
+                print.output()
+                    << fmt::line << "Definition module : translation_unit :="
+                    << fmt::indent << fmt::line
+                    << "Eval cbv beta delta [module_shape] in module_shape";
+                bodies->print_names(print);
+                print.output() << "." << fmt::outdent << fmt::line;
+            }
+
+            if (0 < p.part_size) {
+                std::vector<std::string> parts{p.first_part()};
+                for (unsigned s = 0; s < Printing::SECTIONS; ++s) {
+                    auto section = Printing::Section(s);
+                    for (unsigned j = 1;
+                         j * p.part_size < p.entries[k][section]; ++j) {
+                        parts.push_back(Printing::part_name(section, j));
+                    }
+                }
+                print.output()
+                    << fmt::line << "Definition module : translation_unit := "
+                    << fmt::indent << fmt::line << "Eval " << p.reduction
+                    << " in append_translation_units" << fmt::nbsp;
+                print.list_range(parts.begin(), parts.end(),
+                                 [](auto& print, auto& part) {
+                                     print.output() << part;
+                                 });
+                print.output() << fmt::nbsp << endian << "." << fmt::outdent
+                               << fmt::line;
+            }
         }
-        print.end_list();
-        print.output() << fmt::nbsp;
-        if (ctxt->getTargetInfo().isBigEndian()) {
-            print.output() << "Big";
+        p.module_cprint.intern_names(nullptr);
+        p.module_cprint.share_types(nullptr);
+        p.module_cprint.lazy_bodies(nullptr);
+        p.modules.clear();
+    }
+
+    if (options_.intern_names and options_.output_file.has_value()) {
+        auto path = interned_names_file(*options_.output_file);
+        std::error_code ec;
+        llvm::raw_fd_ostream os(path, ec);
+        if (ec) {
+            llvm::errs() << path << ": " << ec.message() << "\n";
         } else {
-            assert(ctxt->getTargetInfo().isLittleEndian());
-            print.output() << "Little";
+            for (unsigned k = 0; k < p.names.size(); ++k) {
+                if (0 < options_.chunks) {
+                    os << "# "
+                       << llvm::sys::path::filename(
+                              chunk_file(*options_.output_file, k))
+                       << "\n";
+                }
+                p.names[k].write_map(os);
+            }
         }
+    }
 
-        // TODO I still need to generate the initializer
+    // With [--chunks], the module merges the chunks.
+    if (0 < options_.chunks) {
+        with_open_file(options_.output_file, [this, endian](Formatter& fmt) {
+            TimeReport::Scope timer(timing(), TimeReport::PRINT_MODULE);
+            CoqPrinter print(fmt, false);
+            std::vector<std::string> parts;
+            for (unsigned k = 0; k < options_.chunks; ++k) {
+                parts.push_back(llvm::sys::path::stem(
+                                    chunk_file(*options_.output_file, k))
+                                    .str());
+            }
 
-        print.output() << "." << fmt::outdent << fmt::line;
-    });
+            fmt << "Require Import bedrock.lang.cpp.parser." << fmt::line;
+            fmt << "Require";
+            for (auto& part : parts) {
+                fmt << fmt::nbsp << part;
+            }
+            fmt << "." << fmt::line;
+
+            fmt << fmt::line << "Definition module : translation_unit := "
+                << fmt::indent << fmt::line
+                << "Eval " << reduction_name() << " in merge_translation_units"
+                << fmt::nbsp;
+            print.list_range(parts.begin(), parts.end(), [](auto& print, auto& part) {
+                print.output() << part << ".module";
+            });
+            fmt << fmt::nbsp << endian << "." << fmt::outdent << fmt::line;
+        });
+    }
 
-    with_open_file(notations_file_, [this, &decl, &mod](Formatter& spec_fmt) {
+    with_open_file(options_.notations_file, [&](Formatter& spec_fmt) {
+        TimeReport::Scope timer(timing(), TimeReport::PRINT_NAMES);
         auto& ctxt = decl->getASTContext();
         ClangPrinter cprint(compiler_, &decl->getASTContext());
+        cprint.share_names(p.module_cprint);
         CoqPrinter print(spec_fmt, false);
         // PrintSpec printer(ctxt);
 
@@ -132,28 +715,66 @@ ToCoqConsumer::toCoqModule(clang::ASTContext* ctxt,
         write_globals(mod, print, cprint);
     });
 
-    with_open_file(templates_file_, [this, &ctxt, &mod](Formatter& fmt) {
-        CoqPrinter print(fmt, true);
-        ClangPrinter cprint(compiler_, ctxt);
+    if (auto out = p.templates.get()) {
+        TimeReport::Scope timer(timing(), TimeReport::PRINT_TEMPLATES);
+        auto print_decl = [&](const Decl* decl) {
+            printDecl(decl, out->printer(), p.templates_cprint, p.cachep(),
+                      p.profilep());
+        };
+        p.template_declarations.each(print_decl);
+        out->advance(Printing::DEFINITIONS);
+        p.template_definitions.each(print_decl);
+        out->advance(Printing::SECTIONS);
+
+        auto& print = out->printer();
+        print.end_list();
+        print.output() << "." << fmt::outdent << fmt::line;
+        p.templates.reset();
+    }
 
-        fmt << "Require Import bedrock.auto.cpp.templates.mparser." << fmt::line
-            << fmt::line << "#[local] Open Scope bs_scope." << fmt::line;
+    if (p.cache.has_value()) {
+        TimeReport::Scope timer(timing(), TimeReport::SAVE_DECL_CACHE);
+        p.cache->save();
+        logging::log() << "declaration cache: " << p.cache->hits()
+                       << " hits, " << p.cache->misses() << " misses\n";
+    }
 
-        fmt << fmt::line
-            << "Definition templates : Mtranslation_unit :=" << fmt::indent
-            << fmt::line
-            << "Eval Mreduce_translation_unit in Mtranslation_unit.decls"
-            << fmt::nbsp;
+    auto& sm = ctxt->getSourceManager();
+    auto main = sm.getFileEntryForID(sm.getMainFileID());
+    llvm::StringRef main_name = main ? main->getName() : "<main>";
 
-        print.begin_list();
-        for (auto decl : mod.template_declarations()) {
-            printDecl(decl, print, cprint);
+    if (p.profile.has_value()) {
+        if (options_.decl_profile.has_value()) {
+            std::error_code ec;
+            llvm::raw_fd_ostream os(*options_.decl_profile, ec);
+            if (ec) {
+                llvm::errs() << *options_.decl_profile << ": " << ec.message()
+                             << "\n";
+            } else {
+                p.profile->write(os, main_name);
+            }
         }
-        for (auto decl : mod.template_definitions()) {
-            printDecl(decl, print, cprint);
+        if (0 < options_.decl_profile_top) {
+            p.profile->print_top(logging::log(logging::NONE),
+                                 options_.decl_profile_top);
         }
-        print.end_list();
+    }
 
-        print.output() << "." << fmt::outdent << fmt::line;
-    });
+    if (timing_.has_value()) {
+        auto& names = p.module_cprint.name_cache();
+        timing_->cache("names", names.hits, names.misses);
+        auto& types = p.module_cprint.type_cache();
+        auto& template_types = p.templates_cprint.type_cache();
+        timing_->cache("types", types.hits + template_types.hits,
+                       types.misses + template_types.misses);
+        timing_->count("declarations elaborated", elaborator_->declarations());
+        timing_->count("implicit members defined",
+                       elaborator_->implicit_members());
+    }
+
+    printing_.reset();
+
+    if (timing_.has_value()) {
+        timing_->print(logging::log(logging::NONE), main_name);
+    }
 }
@@ -4,7 +4,25 @@
  * See the LICENSE-BedRock file in the repository root for details.
  */
 #include "Version.hpp"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/xxhash.h"
 
 namespace cpp2v {
 const char* const VERSION = GIT_VERSION;
+
+const std::string&
+build_id() {
+    static const std::string id = [] {
+        static int anchor;
+        auto exe = llvm::sys::fs::getMainExecutable("cpp2v", &anchor);
+        auto buffer = llvm::MemoryBuffer::getFile(exe);
+        if (not buffer) {
+            return std::string();
+        }
+        return llvm::utohexstr(llvm::xxHash64((*buffer)->getBuffer()));
+    }();
+    return id;
+}
 }
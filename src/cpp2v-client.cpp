@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+
+/*
+ * Thin client for `cpp2v --serve`.
+ *
+ * `cpp2v-client` takes the same arguments as `cpp2v`. It sends its working
+ * directory and command line to the server listening on the Unix socket
+ * named by `$CPP2V_SOCKET`, prints the server's diagnostics and exits with
+ * the server's exit code. If `$CPP2V_SOCKET` is unset or no server is
+ * listening, it runs `cpp2v` itself, so it can replace `cpp2v` anywhere.
+ *
+ * This file deliberately does not depend on LLVM, to keep start-up cheap.
+ */
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static int
+connect_to(const char *path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path == nullptr or sizeof(addr.sun_path) <= strlen(path)) {
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        return -1;
+    }
+    if (::connect(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) <
+        0) {
+        ::close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static bool
+write_all(int fd, const std::string &data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        auto n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+static bool
+read_all(int fd, std::string &data) {
+    char buf[4096];
+    for (;;) {
+        auto n = ::read(fd, buf, sizeof(buf));
+        if (n == 0) {
+            return true;
+        } else if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.append(buf, n);
+    }
+}
+
+int
+main(int argc, char **argv) {
+    int sock = connect_to(getenv("CPP2V_SOCKET"));
+    if (sock < 0) {
+        argv[0] = const_cast<char *>("cpp2v");
+        execvp(argv[0], argv);
+        perror("cpp2v-client: cpp2v");
+        return 1;
+    }
+
+    char cwd[4096];
+    if (getcwd(cwd, sizeof(cwd)) == nullptr) {
+        perror("cpp2v-client: getcwd");
+        return 1;
+    }
+
+    std::string request(cwd);
+    request.push_back('\0');
+    for (int i = 0; i < argc; ++i) {
+        request.append(argv[i]);
+        request.push_back('\0');
+    }
+
+    std::string reply;
+    if (not write_all(sock, request) or ::shutdown(sock, SHUT_WR) < 0 or
+        not read_all(sock, reply)) {
+        perror("cpp2v-client");
+        return 1;
+    }
+    ::close(sock);
+
+    auto end = reply.rfind('\0');
+    if (end == std::string::npos) {
+        fprintf(stderr, "cpp2v-client: malformed reply from server\n");
+        return 1;
+    }
+    fwrite(reply.data(), 1, end, stderr);
+    return atoi(reply.c_str() + end + 1);
+}
@@ -12,16 +12,37 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include <algorithm>
 #include <optional>
 
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Tooling.h"
 // Declares clang::SyntaxOnlyAction.
 #include "clang/Frontend/FrontendActions.h"
+#include "llvm/ADT/StringMap.h"
 // Declares llvm::cl::extrahelp.
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/xxhash.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include <cstring>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
+#include "FilterSpec.hpp"
 #include "Logging.hpp"
+#include "OutputCache.hpp"
 #include "ToCoq.hpp"
 #include "Version.hpp"
 
@@ -65,8 +86,224 @@ static cl::opt<std::string>
     Templates("templates", cl::desc("generate AST for templated code"),
               cl::Optional, cl::cat(Cpp2V));
 
+static cl::opt<std::string>
+    Serve("serve",
+          cl::desc("serve jobs from cpp2v-client on the given Unix socket"),
+          cl::Optional, cl::cat(Cpp2V));
+
+static cl::opt<unsigned>
+    Jobs("j",
+         cl::desc("number of translation units to process in parallel"),
+         cl::init(1), cl::cat(Cpp2V));
+
+static cl::opt<std::string> CacheDir(
+    "cache-dir",
+    cl::desc("reuse the outputs of earlier runs stored in this directory "
+             "(default: $CPP2V_CACHE_DIR)"),
+    cl::Optional, cl::cat(Cpp2V));
+
+static cl::opt<unsigned>
+    CacheMaxSize("cache-max-size",
+                 cl::desc("maximum size of the output cache in MiB"),
+                 cl::init(1024), cl::cat(Cpp2V));
+
+static cl::opt<std::string> DeclCacheDir(
+    "decl-cache",
+    cl::desc("reuse the text printed for unchanged declarations by earlier "
+             "runs, stored in this directory"),
+    cl::Optional, cl::cat(Cpp2V));
+
+static cl::opt<std::string> TimeReportFormat(
+    "time-report", cl::ValueOptional,
+    cl::desc("print the time spent in each phase (--time-report=json for "
+             "JSON)"),
+    cl::cat(Cpp2V));
+
+static cl::opt<std::string> DeclProfileFile(
+    "decl-profile",
+    cl::desc("write the size and printing time of every declaration to this "
+             "JSON file"),
+    cl::Optional, cl::cat(Cpp2V));
+
+static cl::opt<unsigned> DeclProfileTop(
+    "decl-profile-top",
+    cl::desc("print the given number of declarations with the largest output"),
+    cl::init(0), cl::cat(Cpp2V));
+
+static cl::opt<bool>
+    Compact("compact",
+            cl::desc("print the module and templates with minimal whitespace"),
+            cl::Optional, cl::cat(Cpp2V));
+
+static cl::opt<bool>
+    Stream("stream",
+           cl::desc("print each function as soon as it has been parsed"),
+           cl::Optional, cl::cat(Cpp2V));
+
+static cl::opt<unsigned>
+    Chunks("chunks",
+           cl::desc("split the module into this many files that coqc can "
+                    "compile in parallel"),
+           cl::init(0), cl::cat(Cpp2V));
+
+static cl::opt<bool> CanonTables(
+    "canonical-tables",
+    cl::desc("print the module as sorted, balanced tables rather than a list "
+             "of declarations"),
+    cl::Optional, cl::cat(Cpp2V));
+
+static cl::opt<bool>
+    ShareTypes("share-types",
+               cl::desc("define each type of the module once and refer to it "
+                        "by name"),
+               cl::Optional, cl::cat(Cpp2V));
+
+static cl::opt<bool> InternNames(
+    "intern-names",
+    cl::desc("define each name of the module once and refer to it by a short "
+             "identifier"),
+    cl::Optional, cl::cat(Cpp2V));
+
+static cl::opt<bool> LazyFunctionBodies(
+    "lazy-bodies",
+    cl::desc("define each function body of the module on its own, so that "
+             "computing the module does not reduce it"),
+    cl::Optional, cl::cat(Cpp2V));
+
+static cl::opt<std::string> HeaderModulesDir(
+    "header-modules",
+    cl::desc("print the declarations from each included file to a module of "
+             "its own in this directory, shared between translation units"),
+    cl::Optional, cl::cat(Cpp2V));
+
+static cl::list<std::string> Roots(
+    "roots", cl::CommaSeparated,
+    cl::desc("only print the declarations that those whose qualified names "
+             "match these regular expressions refer to, transitively"),
+    cl::cat(Cpp2V));
+
+static cl::opt<Reduction> ReductionStrategy(
+    "reduction", cl::desc("how coqc computes the module"),
+    cl::values(clEnumValN(Reduction::VM, "vm",
+                          "vm_compute on the whole list (default)"),
+               clEnumValN(Reduction::NATIVE, "native",
+                          "native_compute on the whole list"),
+               clEnumValN(Reduction::LAZY_PER_CHUNK, "lazy-per-chunk",
+                          "lazy on sub-lists of the declarations, then on "
+                          "their combination")),
+    cl::init(Reduction::VM), cl::cat(Cpp2V));
+
+static cl::opt<std::string> FilterFile(
+    "filter",
+    cl::desc("only print the declarations that the rules in this file select "
+             "(see FilterSpec.hpp)"),
+    cl::Optional, cl::cat(Cpp2V));
+
+// The rules read from [FilterFile] by [run], shared by all translation units.
+static std::shared_ptr<const FilterSpec> Filters;
+static std::string FiltersText;
+
+static cl::opt<bool> LazyElaboration(
+    "lazy-elaboration",
+    cl::desc("only define the implicit members of the classes that the "
+             "printed definitions of the main file refer to"),
+    cl::Optional, cl::cat(Cpp2V));
+
+static cl::opt<bool> CacheStats("cache-stats",
+                                cl::desc("print cache statistics and exit"),
+                                cl::Optional, cl::cat(Cpp2V));
+
+template<typename T>
+static std::optional<T>
+to_opt(const cl::opt<T> &val) {
+    if (val.empty()) {
+        return std::optional<T>();
+    } else {
+        return std::optional<T>(val.getValue());
+    }
+}
+
+// With several source files, [-o], [-names], [-templates] and
+// [--decl-profile] name directories, and every translation unit [foo.cpp]
+// gets its own [foo_cpp.v], [foo_cpp_names.v], [foo_cpp_templates.v] and
+// [foo_cpp_profile.json].
+static std::optional<std::string>
+output_for(const cl::opt<std::string> &val, llvm::StringRef InFile,
+           llvm::StringRef suffix, bool per_tu_outputs) {
+    if (not per_tu_outputs or val.empty()) {
+        return to_opt(val);
+    }
+    llvm::SmallString<256> path(val.getValue());
+    llvm::sys::path::append(path,
+                            llvm::sys::path::stem(InFile) + "_cpp" + suffix);
+    return std::string(path.str());
+}
+
+// Unset without [--time-report], [true] for [--time-report=json].
+static std::optional<bool>
+time_report_json() {
+    if (TimeReportFormat.getNumOccurrences() == 0) {
+        return std::nullopt;
+    }
+    return TimeReportFormat == "json";
+}
+
+// The options of the consumer that prints [InFile].
+static ToCoqOptions
+to_coq_options(llvm::StringRef InFile, bool per_tu_outputs) {
+    ToCoqOptions options;
+    options.output_file = output_for(VFileOutput, InFile, ".v", per_tu_outputs);
+    options.notations_file =
+        output_for(NamesFile, InFile, "_names.v", per_tu_outputs);
+    options.templates_file =
+        output_for(Templates, InFile, "_templates.v", per_tu_outputs);
+    options.decl_cache = to_opt(DeclCacheDir);
+    options.time_report_json = time_report_json();
+    options.decl_profile =
+        output_for(DeclProfileFile, InFile, "_profile.json", per_tu_outputs);
+    options.decl_profile_top = DeclProfileTop;
+    options.compact = Compact;
+    options.stream = Stream;
+    options.chunks = Chunks;
+    options.canonical_tables = CanonTables;
+    options.share_types = ShareTypes;
+    options.intern_names = InternNames;
+    options.reduction = ReductionStrategy;
+    options.lazy_bodies = LazyFunctionBodies;
+    options.header_modules = to_opt(HeaderModulesDir);
+    options.roots.assign(Roots.begin(), Roots.end());
+    options.filter_spec = Filters;
+    options.lazy_elaboration = LazyElaboration;
+    return options;
+}
+
+// Everything that affects the contents of the generated files, besides the
+// source and the compiler arguments. Part of the cache key.
+static std::string
+output_mode() {
+    std::string mode;
+    llvm::raw_string_ostream os(mode);
+    os << "o:" << !VFileOutput.empty() << " names:" << !NamesFile.empty()
+       << " templates:" << !Templates.empty() << " compact:" << Compact
+       << " stream:" << Stream << " chunks:" << Chunks
+       << " canonical-tables:" << CanonTables
+       << " share-types:" << ShareTypes << " intern-names:" << InternNames
+       << " reduction:" << unsigned(ReductionStrategy.getValue())
+       << " lazy-bodies:" << LazyFunctionBodies
+       << " header-modules:" << !HeaderModulesDir.empty()
+       << " filter:" << llvm::xxHash64(FiltersText)
+       << " lazy-elaboration:" << LazyElaboration << " roots:";
+    for (auto &root : Roots) {
+        os << root << ",";
+    }
+    return os.str();
+}
+
 class ToCoqAction : public clang::ASTFrontendAction {
 public:
+    explicit ToCoqAction(bool per_tu_outputs = false)
+        : per_tu_outputs_(per_tu_outputs) {}
+
     virtual std::unique_ptr<clang::ASTConsumer>
     CreateASTConsumer(clang::CompilerInstance &Compiler,
                       llvm::StringRef InFile) override {
@@ -77,42 +314,132 @@ public:
             llvm::errs() << i << "\n";
         }
 #endif
-        auto result = new ToCoqConsumer(&Compiler, to_opt(VFileOutput),
-                                        to_opt(NamesFile), to_opt(Templates));
-        return std::unique_ptr<clang::ASTConsumer>(result);
-    }
-
-    template<typename T>
-    std::optional<T> to_opt(const cl::opt<T> &val) {
-        if (val.empty()) {
-            return std::optional<T>();
-        } else {
-            return std::optional<T>(val.getValue());
-        }
+        return std::make_unique<ToCoqConsumer>(
+            &Compiler, to_coq_options(InFile, per_tu_outputs_));
     }
 
     virtual bool BeginSourceFileAction(CompilerInstance &CI) override {
         return this->clang::ASTFrontendAction::BeginSourceFileAction(CI);
     }
+
+private:
+    const bool per_tu_outputs_;
 };
 
-int
-main(int argc, const char **argv) {
-#if CLANG_VERSION >= 13
-    auto MaybeOptionsParser = CommonOptionsParser::create(argc, argv, Cpp2V);
-#else
-    auto MaybeOptionsParser = CommonOptionsParser::create(
-        argc, argv, Cpp2V, cl::NumOccurrencesFlag::Required);
-#endif
-    if (not MaybeOptionsParser) {
-        llvm::errs() << MaybeOptionsParser.takeError();
-        return 1;
+class ToCoqActionFactory : public FrontendActionFactory {
+public:
+    explicit ToCoqActionFactory(bool per_tu_outputs)
+        : per_tu_outputs_(per_tu_outputs) {}
+
+    std::unique_ptr<FrontendAction> create() override {
+        return std::make_unique<ToCoqAction>(per_tu_outputs_);
     }
 
-    auto &OptionsParser = MaybeOptionsParser.get();
+    OutputCache::Outputs outputs(llvm::StringRef source) const {
+        auto module = output_for(VFileOutput, source, ".v", per_tu_outputs_);
+        OutputCache::Outputs outputs{
+            {"module", module},
+            {"names",
+             output_for(NamesFile, source, "_names.v", per_tu_outputs_)},
+            {"templates",
+             output_for(Templates, source, "_templates.v", per_tu_outputs_)},
+        };
+        if (module.has_value()) {
+            for (unsigned k = 0; k < Chunks; ++k) {
+                outputs.push_back({"part_" + std::to_string(k),
+                                   chunk_file(*module, k)});
+            }
+            if (InternNames) {
+                outputs.push_back({"interned", interned_names_file(*module)});
+            }
+        }
+        return outputs;
+    }
 
+private:
+    const bool per_tu_outputs_;
+};
+
+// Convert [source] on its own, going through [cache] if there is one.
+static int
+run_one(const CompilationDatabase &db, const std::string &source,
+        ToCoqActionFactory &factory, OutputCache *cache,
+        DiagnosticConsumer *diags = nullptr,
+        IntrusiveRefCntPtr<FileManager> files = nullptr) {
+    std::optional<std::string> key;
+    auto outputs = factory.outputs(source);
+    if (cache) {
+        key = cache_key(db, source, output_mode(), files.get());
+        // A hit would leave nothing for [--time-report] and [--decl-profile]
+        // to measure, so they always convert (and still store the outputs).
+        bool measured = TimeReportFormat.getNumOccurrences() != 0 or
+                        not DeclProfileFile.empty() or 0 < DeclProfileTop;
+        if (key and not measured and cache->restore(*key, outputs)) {
+            return 0;
+        }
+    }
+
+    ClangTool Tool(db, {source}, std::make_shared<PCHContainerOperations>(),
+                   job_file_system(files.get()), files);
+    Tool.setRestoreWorkingDir(false);
+    if (diags) {
+        Tool.setDiagnosticConsumer(diags);
+    }
+    auto result = Tool.run(&factory);
+
+    if (result == 0 and key) {
+        cache->store(*key, outputs);
+    }
+    return result;
+}
+
+// Run every translation unit in its own [ClangTool] on a pool of [jobs]
+// threads. Diagnostics and log messages of each translation unit are
+// buffered and printed to [errs] in the order of [sources] once all of them
+// are done, so the output does not depend on scheduling.
+static int
+run_parallel(const CompilationDatabase &db,
+             const std::vector<std::string> &sources, unsigned jobs,
+             ToCoqActionFactory &factory, OutputCache *cache,
+             llvm::raw_ostream &errs) {
+    std::vector<std::string> logs(sources.size());
+    std::vector<int> results(sources.size(), 0);
+    {
+        llvm::ThreadPool pool(llvm::hardware_concurrency(jobs));
+        for (size_t i = 0; i < sources.size(); ++i) {
+            pool.async([&, i] {
+                llvm::raw_string_ostream log(logs[i]);
+                logging::set_stream(&log);
+
+                IntrusiveRefCntPtr<DiagnosticOptions> opts(
+                    new DiagnosticOptions());
+                TextDiagnosticPrinter diags(log, opts.get());
+                results[i] = run_one(db, sources[i], factory, cache, &diags);
+
+                logging::set_stream(nullptr);
+                log.flush();
+            });
+        }
+        pool.wait();
+    }
+
+    int result = 0;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        errs << logs[i];
+        result = std::max(result, results[i]);
+    }
+    return result;
+}
+
+// Convert the translation units selected by [OptionsParser]. Messages go to
+// [errs], diagnostics to [diags] (clang's default printer if null). All
+// translation units share [files] (a fresh [FileManager] if null).
+static int
+run(CommonOptionsParser &OptionsParser, llvm::raw_ostream &errs,
+    DiagnosticConsumer *diags = nullptr,
+    IntrusiveRefCntPtr<FileManager> files = nullptr) {
     if (Version) {
-        llvm::errs() << "cpp2v version " << cpp2v::VERSION << "\n";
+        errs << "cpp2v version " << cpp2v::VERSION << "\n";
         return 0;
     }
 
@@ -125,8 +452,629 @@ main(int argc, const char **argv) {
         logging::set_level(logging::NONE);
     }
 
-    ClangTool Tool(OptionsParser.getCompilations(),
-                   OptionsParser.getSourcePathList());
+    if (TimeReportFormat != "" and TimeReportFormat != "json") {
+        errs << "cpp2v: unknown --time-report format '" << TimeReportFormat
+             << "'\n";
+        return 1;
+    }
+
+    if (CanonTables and (Stream or 0 < Chunks)) {
+        errs << "cpp2v: --canonical-tables cannot be combined with --stream "
+                "or --chunks\n";
+        return 1;
+    }
+
+    if (CanonTables and ReductionStrategy == Reduction::LAZY_PER_CHUNK) {
+        errs << "cpp2v: --canonical-tables cannot be combined with "
+                "--reduction=lazy-per-chunk\n";
+        return 1;
+    }
+
+    // With [--stream], the types and names are only known once the
+    // functions that use them have been printed, so every streamed entry
+    // would wait for them in the temporary file.
+    if (ShareTypes and (Stream or not DeclCacheDir.empty())) {
+        errs << "cpp2v: --share-types cannot be combined with --stream or "
+                "--decl-cache\n";
+        return 1;
+    }
+    if (InternNames and (Stream or not DeclCacheDir.empty())) {
+        errs << "cpp2v: --intern-names cannot be combined with --stream or "
+                "--decl-cache\n";
+        return 1;
+    }
+    // The bodies are defined before the module, so with [--stream] they
+    // would only be known at the end as well.
+    if (LazyFunctionBodies and
+        (Stream or CanonTables or not DeclCacheDir.empty() or
+         ReductionStrategy == Reduction::LAZY_PER_CHUNK)) {
+        errs << "cpp2v: --lazy-bodies cannot be combined with --stream, "
+                "--canonical-tables, --decl-cache or "
+                "--reduction=lazy-per-chunk\n";
+        return 1;
+    }
+
+    if (not HeaderModulesDir.empty() and
+        (Stream or 0 < Chunks or CanonTables or ShareTypes or InternNames or
+         LazyFunctionBodies or
+         ReductionStrategy == Reduction::LAZY_PER_CHUNK)) {
+        errs << "cpp2v: --header-modules cannot be combined with --stream, "
+                "--chunks, --canonical-tables, --share-types, "
+                "--intern-names, --lazy-bodies or "
+                "--reduction=lazy-per-chunk\n";
+        return 1;
+    }
+
+    Filters.reset();
+    FiltersText.clear();
+    if (not FilterFile.empty()) {
+        auto buffer = llvm::MemoryBuffer::getFile(FilterFile);
+        if (not buffer) {
+            errs << "cpp2v: " << FilterFile << ": "
+                 << buffer.getError().message() << "\n";
+            return 1;
+        }
+        FiltersText = (*buffer)->getBuffer().str();
+        std::string error;
+        auto spec = FilterSpec::parse(FiltersText, error);
+        if (not spec) {
+            errs << "cpp2v: " << FilterFile << ":" << error << "\n";
+            return 1;
+        }
+        Filters = std::make_shared<const FilterSpec>(std::move(*spec));
+    }
+
+    if (LazyElaboration and Stream) {
+        errs << "cpp2v: --lazy-elaboration cannot be combined with "
+                "--stream\n";
+        return 1;
+    }
+    if (not Roots.empty() and Stream) {
+        errs << "cpp2v: --roots cannot be combined with --stream\n";
+        return 1;
+    }
+    for (auto &root : Roots) {
+        std::string error;
+        if (not llvm::Regex("^(" + root + ")$").isValid(error)) {
+            errs << "cpp2v: invalid --roots pattern '" << root
+                 << "': " << error << "\n";
+            return 1;
+        }
+    }
+
+    std::optional<OutputCache> cache;
+    if (not CacheDir.empty()) {
+        cache.emplace(CacheDir.getValue(), uint64_t(CacheMaxSize) << 20);
+    } else if (auto dir = getenv("CPP2V_CACHE_DIR")) {
+        cache.emplace(dir, uint64_t(CacheMaxSize) << 20);
+    }
+    if (CacheStats) {
+        if (not cache) {
+            errs << "cpp2v: --cache-stats requires a cache directory\n";
+            return 1;
+        }
+        cache->print_stats(errs);
+        return 0;
+    }
+    // The header modules a translation unit uses are only known once it has
+    // been converted, so they cannot be restored from the cache.
+    if (not HeaderModulesDir.empty()) {
+        cache.reset();
+    }
+
+    auto &sources = OptionsParser.getSourcePathList();
+    if (sources.empty()) {
+        errs << "cpp2v: no input files\n";
+        return 1;
+    }
+    // The outputs of several translation units are named after their
+    // stems, which must therefore differ.
+    if (1 < sources.size() and
+        not(VFileOutput.empty() and NamesFile.empty() and Templates.empty() and
+            DeclProfileFile.empty())) {
+        llvm::StringMap<llvm::StringRef> stems;
+        for (auto &source : sources) {
+            auto stem = llvm::sys::path::stem(source);
+            auto [it, fresh] = stems.try_emplace(stem, source);
+            if (not fresh) {
+                errs << "cpp2v: " << it->second << " and " << source
+                     << " would both be written to " << stem << "_cpp*.v\n";
+                return 1;
+            }
+        }
+    }
+    ToCoqActionFactory factory(1 < sources.size());
+    auto &db = OptionsParser.getCompilations();
+
+    if (1 < Jobs && 1 < sources.size()) {
+        return run_parallel(db, sources, Jobs, factory,
+                            cache ? &*cache : nullptr, errs);
+    }
+
+    if (cache) {
+        int result = 0;
+        for (auto &source : sources) {
+            result = std::max(
+                result, run_one(db, source, factory, &*cache, diags, files));
+        }
+        return result;
+    }
+
+    ClangTool Tool(OptionsParser.getCompilations(), sources,
+                   std::make_shared<PCHContainerOperations>(),
+                   llvm::vfs::getRealFileSystem(), files);
+    if (diags) {
+        Tool.setDiagnosticConsumer(diags);
+    }
+
+    return Tool.run(&factory);
+}
+
+static llvm::Expected<CommonOptionsParser>
+parse_options(int argc, const char **argv) {
+    // No source files is only an error outside of server mode (see [run]).
+    return CommonOptionsParser::create(argc, argv, Cpp2V, cl::ZeroOrMore);
+}
+
+// Server mode
+//
+// A job is the working directory and the command line of a cpp2v invocation,
+// each field terminated by a NUL byte, followed by the end of the stream.
+// The reply is everything cpp2v printed to stderr, a NUL byte, and the exit
+// code in decimal. See [cpp2v-client.cpp] for the client side.
+//
+// Every job runs in a child process forked from the server, so that a job
+// that exits (on a fatal error, [--help] or [--version]) only ends its own
+// process: the reply is then what it printed up to that point and the status
+// it exited with. Jobs run concurrently, as the server goes on accepting
+// connections while children run. The server keeps the contents of the files
+// that jobs read (as long as their size and modification time do not change,
+// and up to [ServerCacheBytes]) for the jobs forked after them: when a child
+// is done, the server reads the files that it had to read itself. Everything else, including
+// clang's [FileManager] and its stat cache, is private to a job, so a file
+// created after a job failed to find it is found by the next one.
+
+namespace {
+class CachedFile : public llvm::vfs::File {
+public:
+    CachedFile(llvm::vfs::Status status, const llvm::MemoryBuffer &buffer)
+        : status_(std::move(status)), buffer_(buffer) {}
+
+    llvm::ErrorOr<llvm::vfs::Status> status() override {
+        return status_;
+    }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+    getBuffer(const llvm::Twine &, int64_t, bool RequiresNullTerminator,
+              bool) override {
+        return llvm::MemoryBuffer::getMemBuffer(buffer_.getMemBufferRef(),
+                                                RequiresNullTerminator);
+    }
+
+    std::error_code close() override {
+        return {};
+    }
+
+private:
+    llvm::vfs::Status status_;
+    const llvm::MemoryBuffer &buffer_;
+};
+
+class BufferCachingFileSystem : public llvm::vfs::ProxyFileSystem {
+public:
+    explicit BufferCachingFileSystem(
+        IntrusiveRefCntPtr<llvm::vfs::FileSystem> fs)
+        : ProxyFileSystem(std::move(fs)) {}
+
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+    openFileForRead(const llvm::Twine &name) override {
+        llvm::SmallString<256> path;
+        name.toVector(path);
+        if (auto ec = makeAbsolute(path)) {
+            return ec;
+        }
+        auto st = status(path);
+        if (not st) {
+            return st.getError();
+        }
+        // Only the contents of regular files stay the same while their size
+        // and modification time do.
+        if (st->getType() != llvm::sys::fs::file_type::regular_file) {
+            return ProxyFileSystem::openFileForRead(name);
+        }
+
+        auto &entry = cache_[path];
+        entry.last_use = ++uses_;
+        if (not entry.buffer or entry.size != st->getSize() or
+            entry.mtime != st->getLastModificationTime()) {
+            auto file = ProxyFileSystem::openFileForRead(path);
+            if (not file) {
+                return file.getError();
+            }
+            auto buffer = (*file)->getBuffer(path, st->getSize());
+            if (not buffer) {
+                return buffer.getError();
+            }
+            if (entry.buffer) {
+                total_ -= entry.size;
+            }
+            entry.size = st->getSize();
+            entry.mtime = st->getLastModificationTime();
+            entry.buffer = std::move(*buffer);
+            total_ += entry.size;
+            loaded_.push_back(path.str().str());
+        }
+        return std::unique_ptr<llvm::vfs::File>(new CachedFile(
+            llvm::vfs::Status::copyWithNewName(*st, name), *entry.buffer));
+    }
+
+    // The absolute paths of the files read since the last call.
+    std::vector<std::string> take_loaded() {
+        std::vector<std::string> loaded;
+        loaded.swap(loaded_);
+        return loaded;
+    }
+
+    // Drop the least recently used contents until at most [max] bytes are
+    // kept. Clang refers to the buffers directly, so this must not be called
+    // while a job runs in this process (the server runs each in a child).
+    void trim(uint64_t max) {
+        if (total_ <= max) {
+            return;
+        }
+        std::vector<std::pair<uint64_t, llvm::StringRef>> entries;
+        for (auto &entry : cache_) {
+            entries.emplace_back(entry.second.last_use, entry.first());
+        }
+        std::sort(entries.begin(), entries.end());
+        for (auto &[use, path] : entries) {
+            if (total_ <= max) {
+                break;
+            }
+            auto i = cache_.find(path);
+            total_ -= i->second.buffer ? i->second.size : 0;
+            cache_.erase(i);
+        }
+    }
+
+private:
+    struct Entry {
+        uint64_t size{0};
+        llvm::sys::TimePoint<> mtime;
+        std::unique_ptr<llvm::MemoryBuffer> buffer;
+        uint64_t last_use{0};
+    };
+    llvm::StringMap<Entry> cache_;
+    // The size of the buffers in [cache_].
+    uint64_t total_{0};
+    uint64_t uses_{0};
+    std::vector<std::string> loaded_;
+};
+
+// How many bytes of file contents the server keeps between jobs.
+const uint64_t ServerCacheBytes = uint64_t(1) << 30;
+} // namespace
+
+static int
+run_job(const std::vector<std::string> &job,
+        IntrusiveRefCntPtr<BufferCachingFileSystem> fs,
+        llvm::raw_ostream &out) {
+    if (job.size() < 2) {
+        out << "cpp2v: malformed job\n";
+        return 1;
+    }
+    if (auto ec = llvm::sys::fs::set_current_path(job[0])) {
+        out << job[0] << ": " << ec.message() << "\n";
+        return 1;
+    }
+
+    std::vector<const char *> argv;
+    for (auto i = job.begin() + 1; i != job.end(); ++i) {
+        argv.push_back(i->c_str());
+    }
+    int argc = argv.size();
+    auto MaybeOptionsParser = parse_options(argc, argv.data());
+    if (not MaybeOptionsParser) {
+        out << MaybeOptionsParser.takeError();
+        return 1;
+    }
+    if (not Serve.empty()) {
+        out << "cpp2v: --serve is not allowed in a job\n";
+        return 1;
+    }
+
+    IntrusiveRefCntPtr<DiagnosticOptions> opts(new DiagnosticOptions());
+    TextDiagnosticPrinter diags(out, opts.get());
+    logging::set_stream(&out);
+    IntrusiveRefCntPtr<FileManager> files(
+        new FileManager(FileSystemOptions(), fs));
+    auto result = run(MaybeOptionsParser.get(), out, &diags, files);
+    logging::set_stream(nullptr);
+    return result;
+}
+
+static bool
+read_all(int fd, std::string &data) {
+    char buf[4096];
+    for (;;) {
+        auto n = ::read(fd, buf, sizeof(buf));
+        if (n == 0) {
+            return true;
+        } else if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.append(buf, n);
+    }
+}
+
+static bool
+write_all(int fd, llvm::StringRef data) {
+    while (not data.empty()) {
+        auto n = ::write(fd, data.data(), data.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data = data.drop_front(n);
+    }
+    return true;
+}
+
+namespace {
+// A job whose child process runs. The server reads what the child prints
+// and, once the child has closed its output, the paths of the files it read.
+struct RunningJob {
+    int conn;
+    pid_t pid;
+    int output;
+    int loaded;
+    std::string reply;
+    std::string paths;
+};
+} // namespace
+
+// Parse the fields of a request (see above).
+static std::vector<std::string>
+parse_job(llvm::StringRef request) {
+    if (request.endswith(llvm::StringRef("\0", 1))) {
+        request = request.drop_back();
+    }
+    llvm::SmallVector<llvm::StringRef, 16> fields;
+    request.split(fields, '\0');
+    std::vector<std::string> job;
+    for (auto f : fields) {
+        job.push_back(f.str());
+    }
+    return job;
+}
+
+static void
+send_reply(int conn, std::string reply, int result) {
+    reply.push_back('\0');
+    reply += std::to_string(result);
+    write_all(conn, reply);
+    ::close(conn);
+}
+
+// Start [job], received on [conn], in a child process. The child must not
+// keep the descriptors of the server, [sock] and those of the [running]
+// jobs, open: a client only sees the end of its reply once every process
+// has closed its connection.
+static std::optional<RunningJob>
+fork_job(const std::vector<std::string> &job, int conn,
+         IntrusiveRefCntPtr<BufferCachingFileSystem> fs, int sock,
+         const std::vector<RunningJob> &running) {
+    auto fail = [&](const char *what) {
+        send_reply(conn, std::string("cpp2v: ") + what + ": " +
+                             strerror(errno) + "\n",
+                   1);
+        return std::nullopt;
+    };
+    int output[2], loaded[2];
+    if (::pipe(output) < 0) {
+        return fail("pipe");
+    }
+    if (::pipe(loaded) < 0) {
+        ::close(output[0]);
+        ::close(output[1]);
+        return fail("pipe");
+    }
+    auto pid = ::fork();
+    if (pid < 0) {
+        for (auto fd : {output[0], output[1], loaded[0], loaded[1]}) {
+            ::close(fd);
+        }
+        return fail("fork");
+    }
+
+    if (pid == 0) {
+        ::close(sock);
+        ::close(conn);
+        for (auto &other : running) {
+            for (auto fd : {other.conn, other.output, other.loaded}) {
+                if (0 <= fd) {
+                    ::close(fd);
+                }
+            }
+        }
+        ::close(output[0]);
+        ::close(loaded[0]);
+        ::dup2(output[1], STDOUT_FILENO);
+        ::dup2(output[1], STDERR_FILENO);
+        ::close(output[1]);
+        auto result = run_job(job, fs, llvm::errs());
+        llvm::outs().flush();
+        llvm::errs().flush();
+        // The server reads the output to its end before [loaded].
+        ::close(STDOUT_FILENO);
+        ::close(STDERR_FILENO);
+        std::string paths;
+        for (auto &path : fs->take_loaded()) {
+            paths += path;
+            paths.push_back('\0');
+        }
+        write_all(loaded[1], paths);
+        ::_exit(result);
+    }
+
+    ::close(output[1]);
+    ::close(loaded[1]);
+    return RunningJob{conn, pid, output[0], loaded[0], {}, {}};
+}
+
+// Reap the child of [job], which has closed both pipes, reply to its client
+// and read the files that the child read into [fs] for the next jobs.
+static void
+finish_job(RunningJob &job, IntrusiveRefCntPtr<BufferCachingFileSystem> fs) {
+    int status = 0;
+    while (::waitpid(job.pid, &status, 0) < 0 and errno == EINTR) {
+    }
+    int result = 1;
+    if (WIFEXITED(status)) {
+        result = WEXITSTATUS(status);
+    } else {
+        job.reply += "cpp2v: job killed by signal " +
+                     std::to_string(WTERMSIG(status)) + "\n";
+    }
+    send_reply(job.conn, std::move(job.reply), result);
+
+    llvm::SmallVector<llvm::StringRef, 64> files;
+    llvm::StringRef(job.paths).split(files, '\0', -1, false);
+    for (auto path : files) {
+        (void)fs->openFileForRead(path);
+    }
+    fs->take_loaded();
+    fs->trim(ServerCacheBytes);
+}
+
+// Append what is available on [fd] to [data], and close it at its end.
+static void
+read_some(int &fd, std::string &data) {
+    char buf[4096];
+    auto n = ::read(fd, buf, sizeof(buf));
+    if (n < 0 and errno == EINTR) {
+        return;
+    }
+    if (n <= 0) {
+        ::close(fd);
+        fd = -1;
+        return;
+    }
+    data.append(buf, n);
+}
+
+static int
+serve(llvm::StringRef path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (sizeof(addr.sun_path) <= path.size()) {
+        llvm::errs() << path << ": socket path is too long\n";
+        return 1;
+    }
+    memcpy(addr.sun_path, path.data(), path.size());
+
+    int sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        llvm::errs() << "socket: " << strerror(errno) << "\n";
+        return 1;
+    }
+    // Replace the socket of an earlier server, but nothing else.
+    struct stat st;
+    if (::lstat(addr.sun_path, &st) == 0 and S_ISSOCK(st.st_mode)) {
+        ::unlink(addr.sun_path);
+    }
+    if (::bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 or
+        ::listen(sock, SOMAXCONN) < 0) {
+        llvm::errs() << path << ": " << strerror(errno) << "\n";
+        ::close(sock);
+        return 1;
+    }
+    // A client that goes away must not take the server down.
+    ::signal(SIGPIPE, SIG_IGN);
+
+    IntrusiveRefCntPtr<BufferCachingFileSystem> fs(
+        new BufferCachingFileSystem(llvm::vfs::getRealFileSystem()));
+    // Hash the executable once rather than in every job.
+    cpp2v::build_id();
+
+    // Jobs run concurrently: the server waits for new connections and for
+    // the output of every running job at once.
+    std::vector<RunningJob> running;
+    for (;;) {
+        std::vector<pollfd> fds{{sock, POLLIN, 0}};
+        for (auto &job : running) {
+            fds.push_back({job.output, POLLIN, 0});
+            fds.push_back({job.loaded, POLLIN, 0});
+        }
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            llvm::errs() << "poll: " << strerror(errno) << "\n";
+            break;
+        }
+
+        // A closed pipe has a negative descriptor, which [poll] ignores.
+        for (unsigned i = 0; i < running.size(); ++i) {
+            auto &job = running[i];
+            if (fds[1 + 2 * i].revents) {
+                read_some(job.output, job.reply);
+            }
+            if (fds[2 + 2 * i].revents) {
+                read_some(job.loaded, job.paths);
+            }
+        }
+        for (auto i = running.begin(); i != running.end();) {
+            if (i->output < 0 and i->loaded < 0) {
+                finish_job(*i, fs);
+                i = running.erase(i);
+            } else {
+                ++i;
+            }
+        }
+
+        if (fds[0].revents) {
+            int conn = ::accept(sock, nullptr, nullptr);
+            if (conn < 0) {
+                if (errno == EINTR or errno == ECONNABORTED) {
+                    continue;
+                }
+                llvm::errs() << "accept: " << strerror(errno) << "\n";
+                break;
+            }
+            // Clients send the whole request before they read anything.
+            std::string request;
+            if (not read_all(conn, request)) {
+                ::close(conn);
+                continue;
+            }
+            if (auto job =
+                    fork_job(parse_job(request), conn, fs, sock, running)) {
+                running.push_back(std::move(*job));
+            }
+        }
+    }
+    ::close(sock);
+    ::unlink(addr.sun_path);
+    return 1;
+}
+
+int
+main(int argc, const char **argv) {
+    auto MaybeOptionsParser = parse_options(argc, argv);
+    if (not MaybeOptionsParser) {
+        llvm::errs() << MaybeOptionsParser.takeError();
+        return 1;
+    }
+
+    if (not Serve.empty()) {
+        return serve(Serve);
+    }
 
-    return Tool.run(newFrontendActionFactory<ToCoqAction>().get());
+    return run(MaybeOptionsParser.get(), llvm::errs());
 }
@@ -0,0 +1,48 @@
+The second run restores the outputs from the cache.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v --cache-dir=cache -names test_cpp_names.v -o test_cpp.v test.cpp -- -std=c++17
+  $ mv test_cpp.v test_cpp.v.orig
+  $ mv test_cpp_names.v test_cpp_names.v.orig
+  $ cpp2v --cache-dir=cache -names test_cpp_names.v -o test_cpp.v test.cpp -- -std=c++17
+  $ cmp test_cpp.v test_cpp.v.orig
+  $ cmp test_cpp_names.v test_cpp_names.v.orig
+  $ cpp2v --cache-dir=cache --cache-stats 2>&1 | head -4
+  cache directory: cache
+  hits:            1
+  misses:          1
+  entries:         1
+
+Measuring the run with --time-report or --decl-profile skips the lookup, so
+there is something to measure.
+  $ cpp2v --cache-dir=cache --time-report -names test_cpp_names.v -o test_cpp.v test.cpp -- -std=c++17 2>&1 | grep -c ' total$'
+  1
+  $ cpp2v --cache-dir=cache --decl-profile=profile.json -names test_cpp_names.v -o test_cpp.v test.cpp -- -std=c++17
+  $ test -s profile.json
+  $ cpp2v --cache-dir=cache --cache-stats 2>&1 | head -4
+  cache directory: cache
+  hits:            1
+  misses:          1
+  entries:         1
+
+Changing the flags is a miss.
+  $ cpp2v --cache-dir=cache -o test_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --cache-dir=cache --cache-stats 2>&1 | head -4
+  cache directory: cache
+  hits:            1
+  misses:          2
+  entries:         2
+  $ coqc -w -notation-overridden test_cpp.v
+
+Moving a declaration from a header to the main file changes what --filter
+selects, so it is a miss even though the preprocessed text is the same.
+  $ echo 'declaration path *moved.hpp' > filter.txt
+  $ echo 'int moved() { return 0; }' > moved.hpp
+  $ echo '#include "moved.hpp"' > moved.cpp
+  $ cpp2v --cache-dir=cache --filter=filter.txt -o moved_cpp.v moved.cpp -- -std=c++17
+  $ cat moved.hpp > moved.cpp
+  $ cpp2v --cache-dir=cache --filter=filter.txt -o moved_cpp.v moved.cpp -- -std=c++17
+  $ cpp2v --cache-dir=cache --cache-stats 2>&1 | head -4
+  cache directory: cache
+  hits:            1
+  misses:          4
+  entries:         4
@@ -0,0 +1,26 @@
+With --canonical-tables, the tables are printed as balanced trees that only
+need to be checked, and they hold the same entries as with decls.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o list_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --canonical-tables -o tables_cpp.v test.cpp -- -std=c++17
+  $ grep -c decls tables_cpp.v
+  0
+  [1]
+  $ coqc -Q . test -w -notation-overridden list_cpp.v
+  $ coqc -Q . test -w -notation-overridden tables_cpp.v
+  $ cat > same.v <<EOF
+  > Require Import bedrock.lang.cpp.parser.
+  > Require test.list_cpp test.tables_cpp.
+  > Goal avl.IM.elements test.list_cpp.module.(symbols) =
+  >      avl.IM.elements test.tables_cpp.module.(symbols).
+  > Proof. vm_compute. reflexivity. Qed.
+  > Goal avl.IM.elements test.list_cpp.module.(types) =
+  >      avl.IM.elements test.tables_cpp.module.(types).
+  > Proof. vm_compute. reflexivity. Qed.
+  > EOF
+  $ coqc -Q . test same.v
+
+It cannot be combined with --stream.
+  $ cpp2v --canonical-tables --stream -o tables_cpp.v test.cpp -- -std=c++17
+  cpp2v: --canonical-tables cannot be combined with --stream or --chunks
+  [1]
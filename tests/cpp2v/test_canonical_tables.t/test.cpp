@@ -0,0 +1,38 @@
+int later(int);
+
+namespace ns {
+    struct counter {
+        int n;
+        ~counter() {}
+        void bump() { ++n; }
+    };
+
+    int use(counter& c) {
+        c.bump();
+        return later(c.n);
+    }
+
+    enum color { red, green, blue };
+}
+
+union either {
+    int i;
+    char c;
+};
+
+struct incomplete;
+
+// Destructors and enumerators are keyed by the names that Coq computes.
+struct plain {
+    ~plain() {}
+};
+
+enum class level { low, high };
+
+int later(int x) {
+    return x + 1;
+}
+
+int global = later(1);
+
+static_assert(sizeof(ns::counter) == sizeof(int), "");
@@ -0,0 +1,29 @@
+The printers go down chains of else-if branches, case labels and operator
+calls in a loop rather than by recursion. The modules keep the nesting of
+the source (see shape.v).
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o test_cpp.v test.cpp -- -std=c++17
+  $ coqc -R . test -w -notation-overridden test_cpp.v
+  $ coqc -R . test shape.v
+
+Long chains print every link.
+  $ awk 'BEGIN {
+  >   n = 10000;
+  >   printf "struct Out { Out& operator<<(int); };\n";
+  >   printf "Out& shift(Out& o) { return o";
+  >   for (i = 0; i < n; ++i) printf " << %d", i;
+  >   printf "; }\n";
+  >   printf "int branch(int a) {";
+  >   for (i = 0; i < n; ++i) printf " if (a == %d) return %d; else", i, i;
+  >   printf " return 0; }\n";
+  >   printf "int cases(int a) { switch (a) {";
+  >   for (i = 0; i < n; ++i) printf " case %d:", i;
+  >   printf " return 1; } return 0; }\n";
+  > }' > deep.cpp
+  $ cpp2v -o deep_cpp.v deep.cpp -- -std=c++17
+  $ grep -o 'Emember_call' deep_cpp.v | wc -l
+  10000
+  $ grep -o 'Sif' deep_cpp.v | wc -l
+  10000
+  $ grep -o 'Scase' deep_cpp.v | wc -l
+  10000
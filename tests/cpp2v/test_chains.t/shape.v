@@ -0,0 +1,49 @@
+(*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ *)
+Require Import bedrock.prelude.base.
+From bedrock.lang.cpp Require Import ast.
+Require test.test_cpp.
+
+Definition body (n : obj_name) : option Stmt :=
+  match test.test_cpp.module.(symbols) !! n with
+  | Some (Ofunction f) =>
+    match f.(f_body) with
+    | Some (Impl s) => Some s
+    | _ => None
+    end
+  | _ => None
+  end.
+
+(* Each [else] holds the next [if]. *)
+Goal match body "_Z6branchi"%bs with
+     | Some (Sseq (cons (Sif None _ (Sreturn _)
+                          (Sif None _ (Sreturn _)
+                             (Sif None _ (Sreturn _) (Sreturn _)))) nil)) =>
+       true
+     | _ => false
+     end = true.
+Proof. vm_compute. reflexivity. Qed.
+
+(* The labels and the statements they label are items of the switch. *)
+Goal match body "_Z5casesi"%bs with
+     | Some (Sseq (cons (Sswitch None _
+                          (Sseq (cons (Scase _) (cons (Scase _)
+                                 (cons (Scase _) (cons (Sreturn _)
+                                 (cons Sdefault (cons (Sreturn _) nil)))))))) nil)) =>
+       true
+     | _ => false
+     end = true.
+Proof. vm_compute. reflexivity. Qed.
+
+(* Each call is on the result of the previous one. *)
+Goal match body "_Z5shiftR3Outi"%bs with
+     | Some (Sseq (cons (Sreturn (Some
+         (Emember_call _ (Emember_call _ (Emember_call _ _ (cons _ nil) _)
+                            (cons _ nil) _) (cons _ nil) _))) nil)) =>
+       true
+     | _ => false
+     end = true.
+Proof. vm_compute. reflexivity. Qed.
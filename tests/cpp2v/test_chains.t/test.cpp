@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+struct Out {
+    Out& operator<<(int);
+};
+
+Out&
+shift(Out& o, int a) {
+    return o << a << 1 << 2;
+}
+
+int
+branch(int a) {
+    if (a == 1)
+        return 1;
+    else if (a == 2)
+        return 2;
+    else if (a == 3)
+        return 3;
+    else
+        return 0;
+}
+
+int
+cases(int a) {
+    switch (a) {
+    case 1:
+    case 2:
+    case 3:
+        return 1;
+    default:
+        return 0;
+    }
+}
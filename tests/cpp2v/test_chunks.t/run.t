@@ -0,0 +1,49 @@
+With --chunks, the module is split across files that can be compiled in
+parallel, and merging them gives the same symbols and types.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o whole_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --chunks=3 -o test_cpp.v test.cpp -- -std=c++17
+  $ ls test_cpp*.v
+  test_cpp.v
+  test_cpp_part_0.v
+  test_cpp_part_1.v
+  test_cpp_part_2.v
+  $ coqc -R . test -w -notation-overridden whole_cpp.v
+  $ coqc -R . test -w -notation-overridden test_cpp_part_0.v
+  $ coqc -R . test -w -notation-overridden test_cpp_part_1.v
+  $ coqc -R . test -w -notation-overridden test_cpp_part_2.v
+  $ coqc -R . test -w -notation-overridden test_cpp.v
+  $ cat > same.v <<EOF
+  > Require Import bedrock.lang.cpp.parser.
+  > Require test.whole_cpp test.test_cpp.
+  > Goal avl.IM.elements test.whole_cpp.module.(symbols) =
+  >      avl.IM.elements test.test_cpp.module.(symbols).
+  > Proof. vm_compute. reflexivity. Qed.
+  > Goal avl.IM.elements test.whole_cpp.module.(types) =
+  >      avl.IM.elements test.test_cpp.module.(types).
+  > Proof. vm_compute. reflexivity. Qed.
+  > EOF
+  $ coqc -R . test same.v
+
+Declarations without a name of their own, such as static assertions, are
+spread across the chunks too.
+  $ test 1 -lt "$(grep -l Dstatic_assert test_cpp_part_*.v | wc -l)"
+
+They are placed by their enclosing named context and their order there, so
+adding code above them does not move them to another chunk.
+  $ cat > place.cpp <<EOF
+  > namespace ns {
+  > static_assert(true, "place");
+  > }
+  > EOF
+  $ cpp2v --chunks=3 -o place_cpp.v place.cpp -- -std=c++17
+  $ grep -l Dstatic_assert place_cpp_part_*.v > before.txt
+  $ cat > place.cpp <<EOF
+  > int added() { return 0; }
+  > namespace ns {
+  > int more() { return 1; }
+  > static_assert(true, "place");
+  > }
+  > EOF
+  $ cpp2v --chunks=3 -o place_cpp.v place.cpp -- -std=c++17
+  $ grep -l Dstatic_assert place_cpp_part_*.v | cmp - before.txt
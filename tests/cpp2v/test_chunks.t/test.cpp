@@ -0,0 +1,35 @@
+int later(int);
+
+namespace ns {
+    struct counter {
+        int n;
+        void bump() { ++n; }
+    };
+
+    typedef counter counter_t;
+
+    int use(counter_t& c) {
+        c.bump();
+        return later(c.n);
+    }
+
+    enum color { red, green, blue };
+}
+
+template<typename T>
+T twice(T x) {
+    return x + x;
+}
+
+int later(int x) {
+    return twice(x);
+}
+
+int global = later(1);
+
+static_assert(sizeof(ns::counter) == sizeof(int), "");
+static_assert(sizeof(char) == 1, "");
+static_assert(sizeof(ns::color) <= sizeof(long), "");
+static_assert(alignof(ns::counter) == alignof(int), "");
+static_assert(sizeof(ns::counter_t) == sizeof(ns::counter), "");
+static_assert(true, "");
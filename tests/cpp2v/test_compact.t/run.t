@@ -0,0 +1,19 @@
+With --compact, nothing is indented, lists are printed without spaces and
+the output is smaller.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o pretty_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --compact -o compact_cpp.v test.cpp -- -std=c++17
+  $ grep -c '^ ' compact_cpp.v
+  0
+  [1]
+  $ test $(wc -c < compact_cpp.v) -lt $(wc -c < pretty_cpp.v)
+  $ grep -q ' :: ' pretty_cpp.v
+  $ grep -c ' :: ' compact_cpp.v
+  0
+  [1]
+  $ test $(wc -l < compact_cpp.v) -lt $(wc -l < pretty_cpp.v)
+
+Both denote the same translation unit.
+  $ coqc -Q . test -w -notation-overridden pretty_cpp.v
+  $ coqc -Q . test -w -notation-overridden compact_cpp.v
+  $ same_module pretty_cpp compact_cpp
@@ -0,0 +1,16 @@
+struct point {
+    int x;
+    int y;
+};
+
+int dot(const point& a, const point& b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+int sum(int n) {
+    int s = 0;
+    for (int i = 0; i < n; ++i) {
+        s += i;
+    }
+    return s;
+}
@@ -0,0 +1,20 @@
+Only the declarations that changed are printed again.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -v --decl-cache=decls -o test_cpp.v test.cpp -- -std=c++17 2>&1 | grep "declaration cache"
+  declaration cache: 0 hits, 3 misses
+  $ sed -i 's/return 3;/return 4;/' test.cpp
+  $ cpp2v -v --decl-cache=decls -o test_cpp.v test.cpp -- -std=c++17 2>&1 | grep "declaration cache"
+  declaration cache: 2 hits, 1 misses
+
+The output is the same as without the cache.
+  $ cpp2v -o fresh_cpp.v test.cpp -- -std=c++17
+  $ cmp test_cpp.v fresh_cpp.v
+  $ coqc -w -notation-overridden test_cpp.v
+
+Making a method virtual also makes its overrides virtual, which changes how
+unchanged callers of the overrides are printed.
+  $ cpp2v --decl-cache=decls -o virtual_cpp.v virtual.cpp -- -std=c++17
+  $ sed -i 's/struct B { int m(); };/struct B { virtual int m(); };/' virtual.cpp
+  $ cpp2v --decl-cache=decls -o virtual_cpp.v virtual.cpp -- -std=c++17
+  $ cpp2v -o fresh_virtual_cpp.v virtual.cpp -- -std=c++17
+  $ cmp virtual_cpp.v fresh_virtual_cpp.v
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+
+int f(int x) {
+    return x + 1;
+}
+
+int g(int y) {
+    return f(y) * 2;
+}
+
+int h() {
+    return 3;
+}
@@ -0,0 +1,12 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+
+struct B { int m(); };
+struct D : B { int m(); };
+
+int call(D& d) {
+    return d.m();
+}
@@ -0,0 +1,9 @@
+The summary lists the declarations with the most output first; the byte counts
+and timings are left out here.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v --decl-profile=test_profile.json --decl-profile-top=2 -o test_cpp.v test.cpp -- -std=c++17 2>&1 | tail -n +3 | cut -c24-
+  table (test.cpp:1:5)
+  get (test.cpp:5:5)
+  $ grep -o '"name": "[a-z]*"' test_profile.json | sort
+  "name": "get"
+  "name": "table"
@@ -0,0 +1,14 @@
+inline int lib_helper(int x) {
+    return x * 2;
+}
+
+namespace lib {
+namespace detail {
+inline int hidden() {
+    return 0;
+}
+} // namespace detail
+inline int visible() {
+    return detail::hidden();
+}
+} // namespace lib
@@ -0,0 +1,8 @@
+int before() {
+    return 0;
+}
+
+#line 1 "generated.hpp"
+int generated() {
+    return 1;
+}
@@ -0,0 +1,22 @@
+A filter spec selects what is printed: the last matching rule decides.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v --filter=filter.txt -o test_cpp.v test.cpp -- -std=c++17
+  $ grep -c 'drop_me\|hidden' test_cpp.v
+  0
+  [1]
+  $ grep -q '"_Z7keep_mei"' test_cpp.v
+  $ coqc -Q . test -w -notation-overridden test_cpp.v
+
+Errors in the spec are reported with their line.
+  $ cpp2v --filter=bad.txt -o test_cpp.v test.cpp -- -std=c++17
+  cpp2v: bad.txt:3: unknown action 'exclud' (expected definition, declaration or exclude)
+  [1]
+
+Rules may separate their words with tabs, and paths match the presumed file
+name, which #line can change in the middle of a file.
+  $ printf 'exclude\tpath\t*generated.hpp\n' > line.txt
+  $ cpp2v --filter=line.txt -o line_cpp.v line.cpp -- -std=c++17
+  $ grep -c '_Z9generatedv' line_cpp.v
+  0
+  [1]
+  $ grep -q '"_Z6beforev"' line_cpp.v
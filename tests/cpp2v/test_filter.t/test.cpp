@@ -0,0 +1,9 @@
+#include "lib.hpp"
+
+int keep_me(int x) {
+    return lib_helper(x) + lib::visible();
+}
+
+int drop_me() {
+    return 0;
+}
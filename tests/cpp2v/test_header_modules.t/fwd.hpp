@@ -0,0 +1,5 @@
+#pragma once
+
+struct Pair;
+
+int first(const Pair& p);
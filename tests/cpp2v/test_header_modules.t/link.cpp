@@ -0,0 +1,6 @@
+#include "fwd.hpp"
+#include "pair.hpp"
+
+int second(const Pair& p) {
+    return p.b + first(p);
+}
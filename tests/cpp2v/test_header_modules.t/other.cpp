@@ -0,0 +1,5 @@
+#include "shared.hpp"
+
+int perimeter(const Point& p) {
+    return 2 * norm1(p);
+}
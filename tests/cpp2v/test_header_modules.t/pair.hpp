@@ -0,0 +1,10 @@
+#include "fwd.hpp"
+
+struct Pair {
+    int a;
+    int b;
+};
+
+inline int first(const Pair& p) {
+    return p.a;
+}
@@ -0,0 +1,44 @@
+With --header-modules, the declarations from a header go to a module of
+their own, which the translation units that include it share.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o whole_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --header-modules=. -o test_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --header-modules=. -o other_cpp.v other.cpp -- -std=c++17
+
+test.cpp defines area, which other.cpp does not, yet both need the same
+module of shared.hpp, which declares area.
+  $ ls h_*.v | sed 's/_[0-9a-f]*\.v$//'
+  h_shared_hpp
+  $ grep -c '^Require h_shared_hpp_' test_cpp.v other_cpp.v
+  test_cpp.v:1
+  other_cpp.v:1
+  $ grep -q '"_Z4areaRK5Point"' h_shared_hpp_*.v
+  $ grep -q '"_Z4areaRK5Point"' test_cpp.v
+  $ grep -c '"_Z4areaRK5Point"' other_cpp.v
+  0
+  [1]
+  $ coqc -R . test -w -notation-overridden whole_cpp.v
+  $ coqc -R . test -w -notation-overridden h_*.v
+  $ coqc -R . test -w -notation-overridden test_cpp.v
+  $ coqc -R . test -w -notation-overridden other_cpp.v
+
+The definition of area in test.cpp replaces the declaration from the header.
+  $ same_tables whole_cpp test_cpp
+
+fwd.hpp declares what pair.hpp defines, and its module comes first in the
+merge: the definitions still win.
+  $ cpp2v -o link_whole_cpp.v link.cpp -- -std=c++17
+  $ cpp2v --header-modules=. -o link_cpp.v link.cpp -- -std=c++17
+  $ grep -c '^Require h_fwd_hpp_[0-9a-f]* h_pair_hpp_' link_cpp.v
+  1
+  $ coqc -R . test -w -notation-overridden link_whole_cpp.v
+  $ coqc -R . test -w -notation-overridden h_fwd_hpp_*.v h_pair_hpp_*.v
+  $ coqc -R . test -w -notation-overridden link_cpp.v
+  $ same_tables link_whole_cpp link_cpp
+
+A header module that cannot be written fails the translation unit.
+  $ touch notadir
+  $ cpp2v --header-modules=notadir -o test_cpp.v test.cpp -- -std=c++17 2>&1 | grep -c 'error: cannot write header module notadir/h_shared_hpp_'
+  1
+  $ cpp2v --header-modules=notadir -o test_cpp.v test.cpp -- -std=c++17 2> /dev/null
+  [1]
@@ -0,0 +1,14 @@
+struct Point {
+    int x;
+    int y;
+};
+
+typedef Point point_t;
+
+enum class Color { red, green };
+
+inline int norm1(const Point& p) {
+    return p.x + p.y;
+}
+
+int area(const Point& p);
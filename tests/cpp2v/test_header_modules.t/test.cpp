@@ -0,0 +1,5 @@
+#include "shared.hpp"
+
+int area(const Point& p) {
+    return p.x * p.y;
+}
@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+
+// Equal-looking elements of different types are not runs.
+struct S { long a; char b; short c; long long d; };
+S s = {0, 0, 0, 0};
+
+// Nor are the value initializations that designated initializers leave.
+struct T { long a; char b; short c; long long d; int e; };
+T t = {.e = 1};
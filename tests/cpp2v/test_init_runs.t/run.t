@@ -0,0 +1,29 @@
+Initializer lists with runs of at least four equal elements print each run
+once.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o test_cpp.v test.cpp -- -std=c++17
+  $ grep -c Einitlist_runs test_cpp.v
+  1
+  $ grep -o 'init_run [0-9]*' test_cpp.v
+  init_run 6
+  init_run 1
+  init_run 1
+  init_run 7
+  init_run 1
+  $ coqc -Q . test -w -notation-overridden test_cpp.v
+
+Elements that only differ in the types of their implicit conversions or
+value initializations are not equal.
+  $ cpp2v -o mixed_cpp.v mixed.cpp -- -std=c++20
+  $ grep -c init_run mixed_cpp.v
+  0
+  [1]
+  $ coqc -Q . test -w -notation-overridden mixed_cpp.v
+
+Nested aggregates merge at every level, and each run is printed once.
+  $ cpp2v -o nested_cpp.v nested.cpp -- -std=c++17
+  $ grep -o 'init_run [0-9]*' nested_cpp.v
+  init_run 4
+  init_run 4
+  init_run 4
+  $ coqc -Q . test -w -notation-overridden nested_cpp.v
@@ -0,0 +1,5 @@
+int table[16] = {7, 7, 7, 7, 7, 7, 1, 2, 0, 0, 0, 0, 0, 0, 0, 3};
+
+int rows[3][4] = {{1, 2, 3, 4}, {1, 2, 3, 4}, {1, 2, 3, 4}};
+
+int few[4] = {5, 5, 5, 6};
@@ -0,0 +1,32 @@
+With --intern-names, each name is defined once and the module refers to it
+by a short identifier, here [manhattan] which is called twice. The module
+is smaller and denotes the same translation unit.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o plain_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --intern-names -o interned_cpp.v test.cpp -- -std=c++17
+  $ test 1 -lt $(grep -c '_ZN8geometry9manhattanERKNS_5pointE' plain_cpp.v)
+  $ grep -c '_ZN8geometry9manhattanERKNS_5pointE' interned_cpp.v
+  1
+  $ grep '_ZN8geometry9manhattanERKNS_5pointE' interned_cpp.v | cut -d ' ' -f 1
+  Definition
+  $ test $(wc -c < interned_cpp.v) -lt $(wc -c < plain_cpp.v)
+  $ coqc -Q . test -w -notation-overridden plain_cpp.v
+  $ coqc -Q . test -w -notation-overridden interned_cpp.v
+  $ same_module plain_cpp interned_cpp
+
+The mapping file gives the source name of every interned name.
+  $ grep -P '\t_ZN8geometry9manhattanERKNS_5pointE\t' interned_cpp_interned.tsv | cut -f 3
+  geometry::manhattan
+
+It also works with --share-types and --canonical-tables.
+  $ cpp2v --intern-names --share-types --canonical-tables -o tables_cpp.v test.cpp -- -std=c++17
+  $ coqc -Q . test -w -notation-overridden tables_cpp.v
+
+It cannot be combined with --stream, whose entries would all wait for the
+definitions of the names, or --decl-cache.
+  $ cpp2v --intern-names --stream -o stream_cpp.v test.cpp -- -std=c++17
+  cpp2v: --intern-names cannot be combined with --stream or --decl-cache
+  [1]
+  $ cpp2v --intern-names --decl-cache=cache -o cache_cpp.v test.cpp -- -std=c++17
+  cpp2v: --intern-names cannot be combined with --stream or --decl-cache
+  [1]
@@ -0,0 +1,17 @@
+namespace geometry {
+    struct point {
+        long x;
+        long y;
+        ~point() {}
+    };
+
+    long manhattan(const point& p) {
+        return (p.x < 0 ? -p.x : p.x) + (p.y < 0 ? -p.y : p.y);
+    }
+
+    long farthest(const point& a, const point& b) {
+        long da = manhattan(a);
+        long db = manhattan(b);
+        return da < db ? db : da;
+    }
+}
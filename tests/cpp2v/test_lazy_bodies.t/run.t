@@ -0,0 +1,22 @@
+Each function body (of [f] and of the constructor, destructor and [get] of
+[C]) is defined on its own, and the module applies [module_shape] to them.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o plain_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --lazy-bodies -o lazy_cpp.v test.cpp -- -std=c++17
+  $ grep -q '^Definition body_3 : Stmt :=' lazy_cpp.v
+  $ grep -c 'Definition module_shape' lazy_cpp.v
+  1
+  $ test $(grep -c '^Definition body_' lazy_cpp.v) -ge 4
+  $ grep -c 'Definition body_\|module_shape' plain_cpp.v
+  0
+  [1]
+  $ coqc -Q . test -w -notation-overridden plain_cpp.v
+  $ coqc -Q . test -w -notation-overridden lazy_cpp.v
+  $ same_module plain_cpp lazy_cpp
+
+  $ cpp2v --lazy-bodies --canonical-tables -o tables_cpp.v test.cpp -- -std=c++17
+  cpp2v: --lazy-bodies cannot be combined with --stream, --canonical-tables, --decl-cache or --reduction=lazy-per-chunk
+  [1]
+  $ cpp2v --lazy-bodies --stream -o stream_cpp.v test.cpp -- -std=c++17
+  cpp2v: --lazy-bodies cannot be combined with --stream, --canonical-tables, --decl-cache or --reduction=lazy-per-chunk
+  [1]
@@ -0,0 +1,14 @@
+int f(int x) {
+    return x + 1;
+}
+
+struct C {
+    int x;
+    C() : x(0) {}
+    ~C() {}
+    int get() const {
+        return x;
+    }
+};
+
+int g();
@@ -0,0 +1,7 @@
+struct Used {
+    int y;
+};
+
+struct Unused {
+    int x;
+};
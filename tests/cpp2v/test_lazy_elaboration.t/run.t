@@ -0,0 +1,26 @@
+By default, every class gets its implicit members, including those in headers
+that the main file never uses.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o eager_cpp.v test.cpp -- -std=c++17
+  $ grep -q '"_ZN6UnusedC1ERKS_"' eager_cpp.v
+
+With --lazy-elaboration, only the classes that the module prints in full, and
+those their definitions reach, do. Without a filter, that is every class.
+  $ cpp2v --lazy-elaboration -o all_cpp.v test.cpp -- -std=c++17
+  $ grep -q '"_ZN6UnusedC1ERKS_"' all_cpp.v
+
+A filter that only declares the library leaves its classes alone.
+  $ cat > decls.txt <<EOF
+  > declaration path *lib.hpp
+  > EOF
+  $ cpp2v --lazy-elaboration --filter=decls.txt -o test_cpp.v test.cpp -- -std=c++17
+  $ grep -q '"_ZN5LocalC1ERKS_"' test_cpp.v
+  $ grep -c '"_ZN6UnusedC1ERKS_"' test_cpp.v
+  0
+  [1]
+  $ coqc -Q . test -w -notation-overridden test_cpp.v
+
+It needs the whole translation unit.
+  $ cpp2v --lazy-elaboration --stream -o test_cpp.v test.cpp -- -std=c++17
+  cpp2v: --lazy-elaboration cannot be combined with --stream
+  [1]
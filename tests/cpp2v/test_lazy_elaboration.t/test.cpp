@@ -0,0 +1,9 @@
+#include "lib.hpp"
+
+int get(Used u) {
+    return u.y;
+}
+
+struct Local {
+    int z;
+};
@@ -0,0 +1,12 @@
+/*
+ * Copyright (C) BedRock Systems Inc. 2023
+ *
+ * SPDX-License-Identifier:MIT-0
+ */
+
+struct C {
+    int x;
+    int get() const { return x; }
+};
+
+int bar(const C& c) { return c.get(); }
@@ -0,0 +1,35 @@
+Several translation units are written to separate files in the output
+directories, regardless of the order in which the workers finish.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -j 2 -names . -o . a.cpp b.cpp -- -std=c++17
+  $ ls *_cpp*.v
+  a_cpp.v
+  a_cpp_names.v
+  b_cpp.v
+  b_cpp_names.v
+  $ coqc -w -notation-overridden a_cpp.v
+  $ coqc -w -notation-overridden b_cpp.v
+
+Translation units with the same stem would overwrite each other's outputs.
+  $ cpp2v -j 2 -names . -o . a.cpp sub/a.cpp -- -std=c++17
+  cpp2v: a.cpp and sub/a.cpp would both be written to a_cpp*.v
+  [1]
+
+Each translation unit resolves relative paths against the directory of its
+own compile command, even while the others run.
+  $ mkdir -p db/one/inc db/two/inc
+  $ echo 'int one_value;' > db/one/inc/inc.hpp
+  $ echo 'int two_value;' > db/two/inc/inc.hpp
+  $ printf '#include "inc.hpp"\nint one() { return one_value; }\n' > db/one/one.cpp
+  $ printf '#include "inc.hpp"\nint two() { return two_value; }\n' > db/two/two.cpp
+  $ cat > db/compile_commands.json <<EOF
+  > [{"directory": "$PWD/db/one", "file": "one.cpp",
+  >   "arguments": ["clang++", "-std=c++17", "-Iinc", "-c", "one.cpp"]},
+  >  {"directory": "$PWD/db/two", "file": "two.cpp",
+  >   "arguments": ["clang++", "-std=c++17", "-Iinc", "-c", "two.cpp"]}]
+  > EOF
+  $ cpp2v -j 2 -p db -o . db/one/one.cpp db/two/two.cpp
+  $ grep -q '"_Z3onev"' one_cpp.v
+  $ grep -q '"_Z3twov"' two_cpp.v
+  $ coqc -w -notation-overridden one_cpp.v
+  $ coqc -w -notation-overridden two_cpp.v
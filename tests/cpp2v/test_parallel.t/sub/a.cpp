@@ -0,0 +1,7 @@
+/*
+ * Copyright (C) BedRock Systems Inc. 2023
+ *
+ * SPDX-License-Identifier:MIT-0
+ */
+
+int bar(int x) { return x; }
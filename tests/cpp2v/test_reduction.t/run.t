@@ -0,0 +1,28 @@
+Each strategy changes how the module is computed: native_compute on the
+whole list, or lazy on sub-lists of 64 entries and then on their
+combination.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o vm_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --reduction=native -o native_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --reduction=lazy-per-chunk -o lazy_cpp.v test.cpp -- -std=c++17
+  $ grep -c 'Eval reduce_translation_unit_native in decls' native_cpp.v
+  1
+  $ grep -c 'Eval reduce_translation_unit_lazy in append_translation_units' lazy_cpp.v
+  1
+  $ grep -q 'Definition module_part_2_1 ' lazy_cpp.v
+  $ grep -c 'reduce_translation_unit_' vm_cpp.v
+  0
+  [1]
+
+All of them compute the same module.
+  $ coqc -Q . test -w -notation-overridden vm_cpp.v
+  $ coqc -Q . test -w -notation-overridden,-native-compiler-disabled native_cpp.v
+  $ coqc -Q . test -w -notation-overridden lazy_cpp.v
+  $ same_module vm_cpp native_cpp
+  $ same_module vm_cpp lazy_cpp
+
+lazy-per-chunk needs a list of declarations, which --canonical-tables does
+not print.
+  $ cpp2v --canonical-tables --reduction=lazy-per-chunk -o tables_cpp.v test.cpp -- -std=c++17
+  cpp2v: --canonical-tables cannot be combined with --reduction=lazy-per-chunk
+  [1]
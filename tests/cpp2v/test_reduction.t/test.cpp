@@ -0,0 +1,8 @@
+// Enough entries for several sub-lists with --reduction=lazy-per-chunk,
+// including a declaration that a later definition replaces.
+int f00();
+
+#define F(n) int f##n() { return n; }
+#define F10(n) F(n##0) F(n##1) F(n##2) F(n##3) F(n##4) \
+               F(n##5) F(n##6) F(n##7) F(n##8) F(n##9)
+F10(0) F10(1) F10(2) F10(3) F10(4) F10(5) F10(6) F10(7) F10(8) F10(9)
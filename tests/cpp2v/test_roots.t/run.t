@@ -0,0 +1,23 @@
+With --roots, only the declarations that the roots refer to, transitively,
+are printed.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v --roots=api::run -o test_cpp.v test.cpp -- -std=c++17
+  $ grep -q '"_ZN3api3runEv"' test_cpp.v
+  $ grep -q '"_ZN3api7measureERK5Shape"' test_cpp.v
+  $ grep -q '"_ZNK6Square4areaEv"' test_cpp.v
+  $ grep -q '"_Z5countv"' test_cpp.v
+  $ grep -c 'Unused\|unused' test_cpp.v
+  0
+  [1]
+  $ coqc -Q . test -w -notation-overridden test_cpp.v
+
+Patterns are regular expressions over qualified names.
+  $ cpp2v --roots='api::.*' -o api_cpp.v test.cpp -- -std=c++17
+  $ grep -c 'unused_function' api_cpp.v
+  0
+  [1]
+  $ cpp2v --roots=nothing -o none_cpp.v test.cpp -- -std=c++17
+  cpp2v: warning: no declaration matches --roots
+  $ cpp2v --roots='(' -o bad_cpp.v test.cpp -- -std=c++17
+  cpp2v: invalid --roots pattern '(': parentheses not balanced
+  [1]
@@ -0,0 +1,39 @@
+struct Shape {
+    virtual ~Shape() {}
+    virtual int area() const = 0;
+};
+
+struct Square : Shape {
+    int side;
+    explicit Square(int s) : side(s) {}
+    int area() const override {
+        return side * side;
+    }
+};
+
+typedef unsigned long size_type;
+
+static size_type counter;
+
+size_type count() {
+    return ++counter;
+}
+
+namespace api {
+int measure(const Shape& s) {
+    count();
+    return s.area();
+}
+int run() {
+    Square sq(3);
+    return measure(sq);
+}
+} // namespace api
+
+int unused_function(int x) {
+    return x;
+}
+
+struct Unused {
+    int field;
+};
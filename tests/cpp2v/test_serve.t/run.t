@@ -0,0 +1,47 @@
+With no server listening, cpp2v-client runs cpp2v itself.
+  $ . ../../setup-cpp2v.sh
+  $ CPP2V_SOCKET=none.sock cpp2v-client -names test_cpp_names.v -o test_cpp.v test.cpp -- -std=c++17
+  $ coqc -w -notation-overridden test_cpp.v
+
+The server does not replace a file that is not a socket.
+  $ echo data > taken
+  $ cpp2v --serve=taken
+  taken: Address already in use
+  [1]
+  $ cat taken
+  data
+
+A job run by the server prints the same as cpp2v.
+  $ cpp2v --serve=cpp2v.sock &
+  $ server=$!
+  $ while [ ! -S cpp2v.sock ]; do sleep 0.1; done
+  $ export CPP2V_SOCKET=cpp2v.sock
+  $ cpp2v-client -names served_cpp_names.v -o served_cpp.v test.cpp -- -std=c++17
+  $ cmp test_cpp.v served_cpp.v
+  $ cmp test_cpp_names.v served_cpp_names.v
+
+Jobs that exit, such as --help and --version, get a reply and leave the
+server running.
+  $ cpp2v-client --help > /dev/null
+  $ cpp2v-client --version > /dev/null
+  $ kill -0 $server
+
+A header that was missing for one job is found by the next.
+  $ cpp2v-client -o late_cpp.v late.cpp -- -std=c++17 2>&1 | grep -c "file not found"
+  1
+  $ echo "int late = 1;" > late.hpp
+  $ cpp2v-client -o late_cpp.v late.cpp -- -std=c++17
+  $ grep -q '"_Z1gv"' late_cpp.v
+
+Jobs run concurrently: a job blocked on a header (a named pipe that nothing
+writes to yet) does not hold up the next one.
+  $ mkfifo slow.hpp
+  $ cpp2v-client -o slow_cpp.v slow.cpp -- -std=c++17 &
+  $ slow=$!
+  $ timeout 60 cpp2v-client -names fast_cpp_names.v -o fast_cpp.v test.cpp -- -std=c++17
+  $ cmp test_cpp.v fast_cpp.v
+  $ : > slow.hpp
+  $ wait $slow
+  $ grep -q '"_Z1hv"' slow_cpp.v
+
+  $ kill $server
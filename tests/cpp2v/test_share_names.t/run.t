@@ -0,0 +1,13 @@
+The mangler numbers the unnamed types of internal linkage in the order in
+which it meets them. The module prints the type in unwrap<int> and the
+templates the one in unwrap, so they only get different numbers if both
+printers use the same mangler.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o test_cpp.v --templates=test_cpp_templates.v test.cpp -- -std=c++17
+  $ grep -q '\$_0' test_cpp.v
+  $ grep -q '\$_1' test_cpp_templates.v
+  $ cat test_cpp.v test_cpp_templates.v | grep -o '\$_[0-9]*' | sort -u
+  $_0
+  $_1
+  $ coqc -w -notation-overridden test_cpp.v
+  $ coqc -w -notation-overridden test_cpp_templates.v
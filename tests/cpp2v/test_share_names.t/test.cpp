@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2023 BedRock Systems, Inc.
+ * This software is distributed under the terms of the BedRock Open-Source License.
+ * See the LICENSE-BedRock file in the repository root for details.
+ */
+namespace {
+template<typename T>
+T
+unwrap(T t) {
+    struct {
+        T v;
+    } box{t};
+    return box.v;
+}
+} // namespace
+
+int
+use() {
+    return unwrap(1);
+}
@@ -0,0 +1,25 @@
+With --share-types, each type is defined once and the module refers to it
+by name, so [point] is named in a few definitions rather than wherever it is
+used.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o plain_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --share-types -o shared_cpp.v test.cpp -- -std=c++17
+  $ test $(grep -c 'Tnamed "_Z5point"' shared_cpp.v) -lt $(grep -c 'Tnamed "_Z5point"' plain_cpp.v)
+  $ grep -q '^Definition ty_[0-9]* : type :=' shared_cpp.v
+  $ test $(wc -c < shared_cpp.v) -lt $(wc -c < plain_cpp.v)
+  $ coqc -Q . test -w -notation-overridden plain_cpp.v
+  $ coqc -Q . test -w -notation-overridden shared_cpp.v
+  $ same_module plain_cpp shared_cpp
+
+It also works with --chunks and --canonical-tables.
+  $ cpp2v --share-types --chunks=2 -o chunks_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --share-types --canonical-tables -o tables_cpp.v test.cpp -- -std=c++17
+  $ grep -q '^Definition ty_[0-9]* : type :=' tables_cpp.v
+
+It cannot be combined with --stream or --decl-cache.
+  $ cpp2v --share-types --stream -o shared_cpp.v test.cpp -- -std=c++17
+  cpp2v: --share-types cannot be combined with --stream or --decl-cache
+  [1]
+  $ cpp2v --share-types --decl-cache=cache -o shared_cpp.v test.cpp -- -std=c++17
+  cpp2v: --share-types cannot be combined with --stream or --decl-cache
+  [1]
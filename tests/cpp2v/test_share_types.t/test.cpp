@@ -0,0 +1,22 @@
+struct point {
+    long x;
+    long y;
+};
+
+const point* first(const point* const* ps, unsigned long n) {
+    const point* best = ps[0];
+    for (unsigned long i = 1; i < n; ++i) {
+        if (ps[i]->x < best->x) {
+            best = ps[i];
+        }
+    }
+    return best;
+}
+
+long sum(const point* const* ps, unsigned long n) {
+    long total = 0;
+    for (unsigned long i = 0; i < n; ++i) {
+        total += ps[i]->x + ps[i]->y;
+    }
+    return total;
+}
@@ -0,0 +1,9 @@
+With --stream, functions are printed as soon as they are parsed. They come
+in another order than without it, so the tables of the two modules are
+only equal up to their shape.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o batch_cpp.v test.cpp -- -std=c++17
+  $ cpp2v --stream -o stream_cpp.v test.cpp -- -std=c++17
+  $ coqc -R . test -w -notation-overridden batch_cpp.v
+  $ coqc -R . test -w -notation-overridden stream_cpp.v
+  $ same_tables batch_cpp stream_cpp
@@ -0,0 +1,24 @@
+int later(int);
+
+namespace ns {
+    struct counter {
+        int n;
+        void bump() { ++n; }
+    };
+
+    int use(counter& c) {
+        c.bump();
+        return later(c.n);
+    }
+}
+
+template<typename T>
+T twice(T x) {
+    return x + x;
+}
+
+int later(int x) {
+    return twice(x);
+}
+
+static_assert(sizeof(ns::counter) == sizeof(int), "");
@@ -0,0 +1,26 @@
+Narrow string literals are printed as bytestrings, in which each run of
+unprintable bytes is the list of its bytes.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v -o test_cpp.v test.cpp -- -std=c++17
+  $ grep -o '(string_to_bytes ("say[^)]*"))' test_cpp.v
+  (string_to_bytes ("say ""hi"" \ there"))
+  $ grep -o '(string_to_bytes ("tab.*\]))' test_cpp.v
+  (string_to_bytes ("tab" ++ (BS.parse [Byte.x09]) ++ "here\" ++ (BS.parse [Byte.x0a; Byte.xff])))
+
+Wide literals keep the list of their characters.
+  $ grep -c 'string_to_bytes' test_cpp.v
+  2
+  $ grep -q '119%N' test_cpp.v
+
+  $ coqc -Q . test -w -notation-overridden test_cpp.v
+  $ cat > bytes.v <<EOF
+  > Require Import bedrock.lang.cpp.parser.
+  > #[local] Open Scope bs_scope.
+  > Goal string_to_bytes ("say ""hi"" \ there") =
+  >      [115; 97; 121; 32; 34; 104; 105; 34; 32; 92; 32; 116; 104; 101; 114; 101]%N.
+  > Proof. reflexivity. Qed.
+  > Goal string_to_bytes ("tab" ++ (BS.parse [Byte.x09]) ++ "here\" ++ (BS.parse [Byte.x0a; Byte.xff])) =
+  >      [116; 97; 98; 9; 104; 101; 114; 101; 92; 10; 255]%N.
+  > Proof. reflexivity. Qed.
+  > EOF
+  $ coqc -Q . test bytes.v
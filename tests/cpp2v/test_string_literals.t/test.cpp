@@ -0,0 +1,11 @@
+const char* plain() {
+    return "say \"hi\" \\ there";
+}
+
+const char* escaped() {
+    return "tab\there\\\n\xff";
+}
+
+const wchar_t* wide() {
+    return L"wide";
+}
@@ -0,0 +1,26 @@
+The report lists every phase; the timings themselves vary from run to run.
+  $ . ../../setup-cpp2v.sh
+  $ cpp2v --time-report -o test_cpp.v test.cpp -- -std=c++17 2>&1 | tail -n +2 | cut -c33-
+  Phase
+  frontend
+  elaborate: top-level declarations
+  elaborate: tag definitions
+  elaborate: template specializations
+  elaborate: inline functions
+  elaborate: implicit instantiations
+  elaborate: on demand
+  build module
+  print module
+  print names
+  print templates
+  save declaration cache
+  total
+  Cache
+  names
+  types
+  What
+  declarations elaborated
+  implicit members defined
+  $ cpp2v --time-report=yaml -o test_cpp.v test.cpp -- -std=c++17
+  cpp2v: unknown --time-report format 'yaml'
+  [1]
@@ -0,0 +1,10 @@
+struct C {
+    int x;
+    int get() const {
+        return x;
+    }
+};
+
+int f(C c) {
+    return c.get();
+}
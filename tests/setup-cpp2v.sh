@@ -13,3 +13,29 @@ check_cpp2v() {
   echo "coqc -w -notation-overridden ${base}_cpp.v"
   coqc -w -notation-overridden "${base}_cpp.v"
 }
+
+# Check that the generated files $1.v and $2.v, compiled with [-R . test],
+# define the same module.
+same_module() {
+  cat > "same_$1_$2.v" <<END
+Require test.$1 test.$2.
+Goal test.$1.module = test.$2.module.
+Proof. vm_compute. reflexivity. Qed.
+END
+  coqc -R . test "same_$1_$2.v"
+}
+
+# The same, for modules that are only equal up to the order of their tables.
+same_tables() {
+  cat > "same_$1_$2.v" <<END
+Require Import bedrock.lang.cpp.parser.
+Require test.$1 test.$2.
+Goal avl.IM.elements test.$1.module.(symbols) =
+     avl.IM.elements test.$2.module.(symbols).
+Proof. vm_compute. reflexivity. Qed.
+Goal avl.IM.elements test.$1.module.(types) =
+     avl.IM.elements test.$2.module.(types).
+Proof. vm_compute. reflexivity. Qed.
+END
+  coqc -R . test "same_$1_$2.v"
+}
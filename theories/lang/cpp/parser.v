@@ -120,6 +120,14 @@ Notation Tvariable_array ty e := (Qconst (Tptr ty)) (only parsing).
 Definition Eenum_const_at (e : globname) (ety ty : type) : Expr :=
   Ecast Cintegral (Econst_ref (Gname e) ety) Prvalue ty.
 
+(** cpp2v prints initializer lists with long runs of equal elements, such as
+    lookup tables and zero-filled buffers, as [Einitlist_runs], with each run
+    printed once. *)
+Definition init_run (n : N) (e : Expr) : list Expr :=
+  repeat e (N.to_nat n).
+Definition Einitlist_runs (runs : list (list Expr)) (default : option Expr) (ty : type) : Expr :=
+  Einitlist (concat runs) default ty.
+
 (** ** Statements *)
 
 Section stmt.
@@ -206,4 +214,77 @@ Definition decls ls (e : endian) : translation_unit :=
   ; initializer := nil (* FIXME *)
   ; byte_order := e |}.
 
+(** [cpp2v --canonical-tables] prints the tables of a translation unit as
+    balanced trees, sorted by [bs_cmp], of the same entries as [decls].
+    Importing [table_entries] reads each entry as the value it adds. *)
+Definition table_leaf {V} : IM.Raw.t V := IM.Raw.Leaf.
+Definition table_node {V} (l : IM.Raw.t V) (k : bs) (v : V) (r : IM.Raw.t V) (h : Z) : IM.Raw.t V :=
+  IM.Raw.Node l k v r h.
+
+Module table_entries.
+  Definition Dvariable (_ : obj_name) (t : type) (init : option Expr) : ObjValue :=
+    Ovar t init.
+  Definition Dfunction (_ : obj_name) (f : Func) : ObjValue := Ofunction f.
+  Definition Dmethod (_ : obj_name) (f : Method) : ObjValue := Omethod f.
+  Definition Dconstructor (_ : obj_name) (f : Ctor) : ObjValue := Oconstructor f.
+  Definition Ddestructor (_ : obj_name) (f : Dtor) : ObjValue := Odestructor f.
+
+  Definition Dunion (_ : globname) (o : option Union) : GlobDecl :=
+    from_option Gunion Gtype o.
+  Definition Dstruct (_ : globname) (o : option Struct) : GlobDecl :=
+    from_option Gstruct Gtype o.
+  Definition Denum (_ : globname) (t : type) (branches : list ident) : GlobDecl :=
+    Genum t branches.
+  Definition Denum_constant (_ : globname) (t ut : type) (v : N + Z) (init : option Expr) : GlobDecl :=
+    let v := match v with inl n => Echar n ut | inr z => Eint z ut end in
+    Gconstant t (Some (Ecast Cintegral v Prvalue t)).
+  Definition Dtypedef (_ : globname) (t : type) : GlobDecl := Gtypedef t.
+  Definition Dtype (_ : globname) : GlobDecl := Gtype.
+End table_entries.
+
+(** [cpp2v --chunks] splits the declarations of a translation unit across
+    files by name, so the chunks never define the same name. *)
+Definition merge_translation_units (tus : list translation_unit) (e : endian) : translation_unit :=
+  {| symbols := avl.map_canon $ foldr (fun tu acc => tu.(symbols) ∪ acc) ∅ tus
+  ; types := avl.map_canon $ foldr (fun tu acc => tu.(types) ∪ acc) ∅ tus
+  ; initializer := nil (* FIXME *)
+  ; byte_order := e |}.
+
+(** Whether a value or a type is only declared. *)
+Definition ObjValue_is_declaration (v : ObjValue) : bool :=
+  match v with
+  | Ovar _ init => bool_decide (init = None)
+  | Ofunction f => bool_decide (f.(f_body) = None)
+  | Omethod m => bool_decide (m.(m_body) = None)
+  | Oconstructor c => bool_decide (c.(c_body) = None)
+  | Odestructor d => bool_decide (d.(d_body) = None)
+  end.
+Definition GlobDecl_is_declaration (g : GlobDecl) : bool :=
+  match g with
+  | Gtype => true
+  | _ => false
+  end.
+
+(** [cpp2v --header-modules] merges the module of a translation unit with
+    those of its headers, which may declare what another one defines. A
+    definition beats a declaration whatever the order of [tus]; otherwise,
+    as in [merge_translation_units], earlier ones take precedence. *)
+Definition prefer_definition {V} (is_declaration : V -> bool) (a b : V) : option V :=
+  Some (if is_declaration a && negb (is_declaration b) then b else a).
+Definition link_translation_units (tus : list translation_unit) (e : endian) : translation_unit :=
+  {| symbols := avl.map_canon $
+       foldr (fun tu acc => union_with (prefer_definition ObjValue_is_declaration) tu.(symbols) acc) ∅ tus
+  ; types := avl.map_canon $
+       foldr (fun tu acc => union_with (prefer_definition GlobDecl_is_declaration) tu.(types) acc) ∅ tus
+  ; initializer := nil (* FIXME *)
+  ; byte_order := e |}.
+
+(** [cpp2v --reduction=lazy-per-chunk] computes sub-lists of the
+    declarations separately. Later ones take precedence, as in [decls]. *)
+Definition append_translation_units (tus : list translation_unit) (e : endian) : translation_unit :=
+  merge_translation_units (rev tus) e.
+
+(** The reductions that [cpp2v --reduction] selects. *)
 Declare Reduction reduce_translation_unit := vm_compute.
+Declare Reduction reduce_translation_unit_native := native_compute.
+Declare Reduction reduce_translation_unit_lazy := lazy.